@@ -0,0 +1,231 @@
+#ifndef __CSR_GRAPH_HPP__
+#define __CSR_GRAPH_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+#include "WeightedGraph.hpp"
+
+/*
+ * Неизменяемый взвешенный граф в формате CSR (compressed sparse row):
+ * соседи вершины u лежат в targets_[offsets_[u] .. offsets_[u + 1]), веса — в weights_ с теми же индексами.
+ * Вершины — 32-битные, соседи каждой вершины упорядочены по номеру (как в std::map у WeightedGraph).
+ * Неориентированное ребро хранится дважды, т.е. 4 + sizeof (WeightT) байт на направленное ребро.
+ */
+template <typename WeightT>
+class CSRGraph
+{
+    std::vector <uint64_t> offsets_;
+    std::vector <uint32_t> targets_;
+    std::vector <WeightT> weights_;
+
+public:
+
+    using WeightedEdge = typename WeightedGraph<WeightT>::WeightedEdge;
+
+    class NeibIterator
+    {
+        const uint32_t *target_;
+        const WeightT *weight_;
+
+    public:
+
+        NeibIterator (const uint32_t *target, const WeightT *weight):
+            target_ (target),
+            weight_ (weight)
+        {}
+
+        std::pair <size_t, WeightT> operator* () const
+        {
+            return {*target_, *weight_};
+        }
+
+        NeibIterator &operator++ ()
+        {
+            ++target_;
+            ++weight_;
+            return *this;
+        }
+
+        bool operator!= (const NeibIterator &other) const
+        {
+            return target_ != other.target_;
+        }
+
+        bool operator== (const NeibIterator &other) const
+        {
+            return target_ == other.target_;
+        }
+    };
+
+    // Диапазон соседей: for (auto [v, weight]: g.getNeibs (u)), как у WeightedGraph
+    class NeibRange
+    {
+        const uint32_t *targets_;
+        const WeightT *weights_;
+        size_t count_;
+
+    public:
+
+        NeibRange (const uint32_t *targets, const WeightT *weights, size_t count):
+            targets_ (targets),
+            weights_ (weights),
+            count_ (count)
+        {}
+
+        NeibIterator begin () const { return {targets_, weights_}; }
+        NeibIterator end () const { return {targets_ + count_, weights_ + count_}; }
+
+        inline size_t size () const { return count_; }
+        inline bool empty () const { return count_ == 0; }
+
+        // Непосредственный доступ к упакованным массивам для плотных циклов
+        inline const uint32_t *targets () const { return targets_; }
+        inline const WeightT *weights () const { return weights_; }
+    };
+
+    CSRGraph ():
+        offsets_ (1, 0)
+    {}
+
+    explicit CSRGraph (const WeightedGraph<WeightT> &g):
+        offsets_ (g.size () + 1, 0)
+    {
+        assert (g.size () < UINT32_MAX);
+
+        size_t n = g.size ();
+        for (size_t u = 0; u < n; u++)
+            offsets_[u + 1] = offsets_[u] + g.getNeibs(u).size ();
+
+        targets_.resize (offsets_[n]);
+        weights_.resize (offsets_[n]);
+
+        for (size_t u = 0; u < n; u++)
+        {
+            uint64_t pos = offsets_[u];
+            for (auto [v, weight]: g.getNeibs(u))
+            {
+                targets_[pos] = (uint32_t) v;
+                weights_[pos] = weight;
+                pos++;
+            }
+        }
+    }
+
+    // Из списка неориентированных рёбер. Повторное ребро (u, v) игнорируется, как в WeightedGraph::insert.
+    // directed: ребро (u, v) кладётся только в список u (для ориентированных графов вроде UnweightedGraph)
+    CSRGraph (size_t count, const std::vector <WeightedEdge> &edges, bool directed = false):
+        offsets_ (count + 1, 0)
+    {
+        assert (count < UINT32_MAX);
+
+        for (auto &edge: edges)
+        {
+            offsets_[edge.u + 1]++;
+            if (!directed && edge.u != edge.v)
+                offsets_[edge.v + 1]++;
+        }
+        for (size_t u = 0; u < count; u++)
+            offsets_[u + 1] += offsets_[u];
+
+        targets_.resize (offsets_[count]);
+        weights_.resize (offsets_[count]);
+
+        std::vector <uint64_t> pos (offsets_.begin (), offsets_.end () - 1);
+        for (auto &edge: edges)
+        {
+            targets_[pos[edge.u]] = (uint32_t) edge.v;
+            weights_[pos[edge.u]++] = edge.weight;
+            if (!directed && edge.u != edge.v)
+            {
+                targets_[pos[edge.v]] = (uint32_t) edge.u;
+                weights_[pos[edge.v]++] = edge.weight;
+            }
+        }
+
+        sortAndCompact ();
+    }
+
+    inline size_t size () const
+    {
+        return offsets_.size () - 1;
+    }
+
+    // Число направленных рёбер (неориентированное считается дважды)
+    inline size_t edgeCount () const
+    {
+        return targets_.size ();
+    }
+
+    inline size_t degree (size_t u) const
+    {
+        return offsets_[u + 1] - offsets_[u];
+    }
+
+    inline NeibRange getNeibs (size_t u) const
+    {
+        return {targets_.data () + offsets_[u], weights_.data () + offsets_[u], degree (u)};
+    }
+
+    bool contains (size_t u, size_t v) const
+    {
+        const uint32_t *first = targets_.data () + offsets_[u], *last = targets_.data () + offsets_[u + 1];
+        const uint32_t *it = std::lower_bound (first, last, (uint32_t) v);
+        return it != last && *it == v;
+    }
+
+    WeightT getWeight (size_t u, size_t v) const
+    {
+        const uint32_t *first = targets_.data () + offsets_[u], *last = targets_.data () + offsets_[u + 1];
+        const uint32_t *it = std::lower_bound (first, last, (uint32_t) v);
+        if (it == last || *it != v)
+            return (WeightT) 0;
+        return weights_[it - targets_.data ()];
+    }
+
+    inline size_t bytes () const
+    {
+        return offsets_.size () * sizeof (uint64_t) + targets_.size () * (sizeof (uint32_t) + sizeof (WeightT));
+    }
+
+private:
+
+    // Сортирует соседей каждой вершины по номеру, оставляя первое вхождение повторов, и уплотняет массивы
+    void sortAndCompact ()
+    {
+        std::vector <std::pair <uint32_t, WeightT>> row;
+        uint64_t write = 0;
+
+        for (size_t u = 0; u < size (); u++)
+        {
+            uint64_t begin = offsets_[u], end = offsets_[u + 1];
+            row.clear ();
+            for (uint64_t i = begin; i < end; i++)
+                row.push_back ({targets_[i], weights_[i]});
+
+            std::stable_sort (row.begin (), row.end (),
+                              [] (const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+            offsets_[u] = write;
+            for (size_t i = 0; i < row.size (); i++)
+            {
+                if (i > 0 && row[i].first == row[i - 1].first)
+                    continue;
+                targets_[write] = row[i].first;
+                weights_[write] = row[i].second;
+                write++;
+            }
+        }
+
+        offsets_[size ()] = write;
+        targets_.resize (write);
+        weights_.resize (write);
+        targets_.shrink_to_fit ();
+        weights_.shrink_to_fit ();
+    }
+};
+
+#endif // ! __CSR_GRAPH_HPP__
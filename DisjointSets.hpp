@@ -0,0 +1,65 @@
+#ifndef __DISJOINT_SETS_HPP__
+#define __DISJOINT_SETS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+/*
+ * Система непересекающихся множеств: объединение по рангу и сжатие путей (итеративное,
+ * чтобы не упираться в стек на длинных цепочках). Амортизированно O(α(n)) на операцию.
+ */
+class DisjointSets
+{
+    std::vector <uint32_t> parent_;
+    std::vector <uint8_t> rank_;
+
+public:
+
+    explicit DisjointSets (size_t count):
+        parent_ (count),
+        rank_ (count, 0)
+    {
+        for (size_t i = 0; i < count; i++)
+            parent_[i] = (uint32_t) i;
+    }
+
+    size_t find (size_t x)
+    {
+        size_t root = x;
+        while (parent_[root] != root)
+            root = parent_[root];
+
+        while (parent_[x] != root)
+        {
+            size_t next = parent_[x];
+            parent_[x] = (uint32_t) root;
+            x = next;
+        }
+        return root;
+    }
+
+    // Возвращает false, если x и y уже в одном множестве
+    bool unite (size_t x, size_t y)
+    {
+        x = find (x);
+        y = find (y);
+        if (x == y)
+            return false;
+
+        if (rank_[x] < rank_[y])
+            std::swap (x, y);
+        parent_[y] = (uint32_t) x;
+        if (rank_[x] == rank_[y])
+            rank_[x]++;
+        return true;
+    }
+
+    inline size_t size () const
+    {
+        return parent_.size ();
+    }
+};
+
+#endif // ! __DISJOINT_SETS_HPP__
@@ -0,0 +1,462 @@
+#ifndef __DYNAMIC_MST_HPP__
+#define __DYNAMIC_MST_HPP__
+
+/*
+ * Минимальный остовный лес под вставками и удалениями рёбер.
+ *
+ * Лес хранится в link-cut дереве (Sleator, Tarjan), где каждое ребро леса — отдельный узел
+ * с весом, а агрегат пути — узел максимального веса. Вставка (u, v, w):
+ *   - u и v в разных деревьях — ребро входит в лес;
+ *   - иначе ищем самое тяжёлое ребро на пути u..v; если оно тяжелее w, заменяем его новым,
+ *     вытесненное становится недревесным; иначе новое ребро сразу недревесное.
+ * Вставка — O(log n) амортизированно.
+ *
+ * Удаление недревесного ребра — O(1). Удаление ребра леса разрезает дерево; обе половины
+ * обходятся по рёбрам леса поочерёдно, пока одна из них не закончится, и среди рёбер, выходящих
+ * из меньшей половины, выбирается самое лёгкое: O(s + deg (s) + log n), где s — размер меньшей
+ * половины. Полилогарифмическая гарантия для удалений требует структуры
+ * Holm–de Lichtenberg–Thorup и здесь не реализована.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <utility>
+#include <cassert>
+#include "WeightedGraph.hpp"
+
+template <typename WeightT>
+class LinkCutTree
+{
+    // узел 0 — пустой
+    std::vector <uint32_t> parent_;
+    std::vector <uint32_t> left_, right_;
+    std::vector <bool> reversed_;
+    std::vector <WeightT> value_;
+    std::vector <bool> edge_;
+    std::vector <uint32_t> max_;
+
+    inline bool isRoot (uint32_t x) const
+    {
+        uint32_t p = parent_[x];
+        return p == 0 || (left_[p] != x && right_[p] != x);
+    }
+
+    // Сравнение по (ребро ли, вес): вершина не становится максимумом пути, даже если вес
+    // ребра равен lowest () (0 у беззнаковых)
+    inline bool heavier (uint32_t a, uint32_t b) const
+    {
+        return edge_[a] != edge_[b] ? edge_[a] : value_[a] > value_[b];
+    }
+
+    void pull (uint32_t x)
+    {
+        max_[x] = x;
+        if (left_[x] && heavier (max_[left_[x]], max_[x]))
+            max_[x] = max_[left_[x]];
+        if (right_[x] && heavier (max_[right_[x]], max_[x]))
+            max_[x] = max_[right_[x]];
+    }
+
+    void push (uint32_t x)
+    {
+        if (!reversed_[x])
+            return;
+        std::swap (left_[x], right_[x]);
+        if (left_[x])  reversed_[left_[x]] = !reversed_[left_[x]];
+        if (right_[x]) reversed_[right_[x]] = !reversed_[right_[x]];
+        reversed_[x] = false;
+    }
+
+    void rotate (uint32_t x)
+    {
+        uint32_t y = parent_[x], z = parent_[y];
+        bool isRight = right_[y] == x;
+
+        if (!isRoot (y))
+            (left_[z] == y ? left_[z] : right_[z]) = x;
+        parent_[x] = z;
+
+        uint32_t middle = isRight ? left_[x] : right_[x];
+        (isRight ? right_[y] : left_[y]) = middle;
+        if (middle)
+            parent_[middle] = y;
+
+        (isRight ? left_[x] : right_[x]) = y;
+        parent_[y] = x;
+
+        pull (y);
+        pull (x);
+    }
+
+    void splay (uint32_t x)
+    {
+        // отложенные развороты проталкиваются сверху вниз до x
+        stack_.clear ();
+        for (uint32_t y = x;; y = parent_[y])
+        {
+            stack_.push_back (y);
+            if (isRoot (y))
+                break;
+        }
+        for (auto it = stack_.rbegin (); it != stack_.rend (); ++it)
+            push (*it);
+
+        while (!isRoot (x))
+        {
+            uint32_t y = parent_[x], z = parent_[y];
+            if (!isRoot (y))
+                rotate ((left_[y] == x) != (left_[z] == y) ? x : y);
+            rotate (x);
+        }
+    }
+
+    void access (uint32_t x)
+    {
+        for (uint32_t last = 0, y = x; y; last = y, y = parent_[y])
+        {
+            splay (y);
+            right_[y] = last;
+            pull (y);
+        }
+        splay (x);
+    }
+
+    void makeRoot (uint32_t x)
+    {
+        access (x);
+        reversed_[x] = !reversed_[x];
+    }
+
+    std::vector <uint32_t> stack_;
+
+public:
+
+    // Узлы-вершины 1..count; узлы рёбер добавляются addNode и одни участвуют в максимуме пути
+    explicit LinkCutTree (size_t count):
+        parent_ (count + 1, 0),
+        left_ (count + 1, 0), right_ (count + 1, 0),
+        reversed_ (count + 1, false),
+        value_ (count + 1, std::numeric_limits<WeightT>::lowest ()),
+        edge_ (count + 1, false),
+        max_ (count + 1)
+    {
+        for (size_t x = 0; x <= count; x++)
+            max_[x] = (uint32_t) x;
+    }
+
+    uint32_t addNode (WeightT value)
+    {
+        parent_.push_back (0);
+        left_.push_back (0);
+        right_.push_back (0);
+        reversed_.push_back (false);
+        value_.push_back (value);
+        edge_.push_back (true);
+        max_.push_back ((uint32_t) (value_.size () - 1));
+        return (uint32_t) (value_.size () - 1);
+    }
+
+    // Переиспользовать изолированный узел с новым весом
+    void resetNode (uint32_t x, WeightT value)
+    {
+        assert (parent_[x] == 0 && left_[x] == 0 && right_[x] == 0);
+        reversed_[x] = false;
+        value_[x] = value;
+        max_[x] = x;
+    }
+
+    uint32_t findRoot (uint32_t x)
+    {
+        access (x);
+        while (true)
+        {
+            push (x);
+            if (!left_[x])
+                break;
+            x = left_[x];
+        }
+        splay (x);
+        return x;
+    }
+
+    inline bool connected (uint32_t x, uint32_t y)
+    {
+        return findRoot (x) == findRoot (y);
+    }
+
+    // x и y в разных деревьях
+    void link (uint32_t x, uint32_t y)
+    {
+        makeRoot (x);
+        parent_[x] = y;
+    }
+
+    // x и y соединены ребром дерева
+    void cut (uint32_t x, uint32_t y)
+    {
+        makeRoot (x);
+        access (y);
+        assert (left_[y] == x && !right_[x]);
+        left_[y] = 0;
+        parent_[x] = 0;
+        pull (y);
+    }
+
+    // Узел-ребро максимального веса на пути x..y (x и y связаны, x != y)
+    uint32_t pathMax (uint32_t x, uint32_t y)
+    {
+        makeRoot (x);
+        access (y);
+        return max_[y];
+    }
+};
+
+template <typename WeightT>
+class DynamicMST
+{
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Edge
+    {
+        uint32_t u, v;
+        WeightT weight;
+        uint32_t node;      // узел в LinkCutTree, 0 — ребро не в лесу
+        uint32_t posU, posV; // позиции в incident_[u], incident_[v]
+    };
+
+    size_t n_;
+    LinkCutTree<WeightT> forest_;
+    std::vector <Edge> edges_;
+    std::vector <uint32_t> freeEdges_;
+    std::vector <uint32_t> nodeEdge_;          // узел LinkCutTree -> номер ребра
+    std::vector <uint32_t> freeNodes_;
+    std::unordered_map <uint64_t, uint32_t> index_;
+    std::vector <std::vector <uint32_t>> incident_;
+    std::vector <uint64_t> mark_;              // 2 * эпоха + сторона разреза
+    uint64_t epoch_;
+    std::vector <uint32_t> queue_[2];
+    WeightT total_;
+    size_t treeEdges_;
+
+    static inline uint64_t key (size_t u, size_t v)
+    {
+        if (u > v) std::swap (u, v);
+        return (uint64_t) u << 32 | v;
+    }
+
+    inline uint32_t vertexNode (size_t v) const
+    {
+        return (uint32_t) v + 1;
+    }
+
+    inline uint32_t other (const Edge &edge, uint32_t v) const
+    {
+        return edge.u == v ? edge.v : edge.u;
+    }
+
+    void detach (uint32_t id)
+    {
+        const Edge &edge = edges_[id];
+        for (int end = 0; end < 2; end++)
+        {
+            uint32_t v = end ? edge.v : edge.u;
+            uint32_t pos = end ? edge.posV : edge.posU;
+            auto &list = incident_[v];
+
+            uint32_t moved = list.back ();
+            list[pos] = moved;
+            list.pop_back ();
+            if (moved != id)
+                (edges_[moved].u == v ? edges_[moved].posU : edges_[moved].posV) = pos;
+        }
+    }
+
+    // Самое лёгкое недревесное ребро между половинами дерева после разреза u-v, NONE — нет
+    uint32_t findReplacement (uint32_t u, uint32_t v)
+    {
+        epoch_++;
+        uint64_t sideMark[2] = {2 * epoch_, 2 * epoch_ + 1};
+        uint32_t start[2] = {u, v};
+        size_t head[2] = {0, 0};
+
+        for (int side = 0; side < 2; side++)
+        {
+            queue_[side].clear ();
+            queue_[side].push_back (start[side]);
+            mark_[start[side]] = sideMark[side];
+        }
+
+        // поочерёдный обход обеих половин; первая исчерпанная — меньшая
+        int smaller = -1;
+        while (smaller < 0)
+        {
+            for (int side = 0; side < 2 && smaller < 0; side++)
+            {
+                if (head[side] == queue_[side].size ())
+                {
+                    smaller = side;
+                    break;
+                }
+
+                uint32_t x = queue_[side][head[side]++];
+                for (uint32_t id: incident_[x])
+                {
+                    uint32_t y = other (edges_[id], x);
+                    if (edges_[id].node != 0 && mark_[y] != sideMark[side])
+                    {
+                        mark_[y] = sideMark[side];
+                        queue_[side].push_back (y);
+                    }
+                }
+            }
+        }
+
+        uint32_t best = NONE;
+        for (uint32_t x: queue_[smaller])
+            for (uint32_t id: incident_[x])
+            {
+                const Edge &edge = edges_[id];
+                if (edge.node != 0 || mark_[other (edge, x)] == sideMark[smaller])
+                    continue;
+                if (best == NONE || edge.weight < edges_[best].weight ||
+                    (edge.weight == edges_[best].weight && id < best))
+                    best = id;
+            }
+
+        return best;
+    }
+
+    void addToForest (uint32_t id)
+    {
+        Edge &edge = edges_[id];
+        if (freeNodes_.empty ())
+        {
+            edge.node = forest_.addNode (edge.weight);
+            nodeEdge_.resize (edge.node + 1, NONE);
+        }
+        else
+        {
+            edge.node = freeNodes_.back ();
+            freeNodes_.pop_back ();
+            forest_.resetNode (edge.node, edge.weight);
+        }
+        nodeEdge_[edge.node] = id;
+
+        forest_.link (vertexNode (edge.u), edge.node);
+        forest_.link (edge.node, vertexNode (edge.v));
+        total_ += edge.weight;
+        treeEdges_++;
+    }
+
+    void removeFromForest (uint32_t id)
+    {
+        Edge &edge = edges_[id];
+        forest_.cut (vertexNode (edge.u), edge.node);
+        forest_.cut (edge.node, vertexNode (edge.v));
+        freeNodes_.push_back (edge.node);
+        nodeEdge_[edge.node] = NONE;
+        edge.node = 0;
+        total_ -= edge.weight;
+        treeEdges_--;
+    }
+
+public:
+
+    explicit DynamicMST (size_t count):
+        n_ (count),
+        forest_ (count),
+        nodeEdge_ (count + 1, NONE),
+        incident_ (count),
+        mark_ (count, 0),
+        epoch_ (0),
+        total_ { },
+        treeEdges_ (0)
+    {
+        assert (count < UINT32_MAX);
+    }
+
+    // Возвращает false, если ребро уже есть или это петля
+    bool insert (size_t u, size_t v, WeightT weight)
+    {
+        if (u == v || index_.contains (key (u, v)))
+            return false;
+
+        uint32_t id;
+        if (freeEdges_.empty ())
+        {
+            id = (uint32_t) edges_.size ();
+            edges_.push_back ({});
+        }
+        else
+        {
+            id = freeEdges_.back ();
+            freeEdges_.pop_back ();
+        }
+        edges_[id] = {(uint32_t) u, (uint32_t) v, weight, 0,
+                      (uint32_t) incident_[u].size (), (uint32_t) incident_[v].size ()};
+        index_[key (u, v)] = id;
+        incident_[u].push_back (id);
+        incident_[v].push_back (id);
+
+        if (!forest_.connected (vertexNode (u), vertexNode (v)))
+        {
+            addToForest (id);
+            return true;
+        }
+
+        uint32_t heaviest = nodeEdge_[forest_.pathMax (vertexNode (u), vertexNode (v))];
+        if (weight < edges_[heaviest].weight)
+        {
+            removeFromForest (heaviest);
+            addToForest (id);
+        }
+
+        return true;
+    }
+
+    bool erase (size_t u, size_t v)
+    {
+        auto it = index_.find (key (u, v));
+        if (it == index_.end ())
+            return false;
+
+        uint32_t id = it->second;
+        index_.erase (it);
+        freeEdges_.push_back (id);
+        detach (id);
+
+        if (edges_[id].node == 0)
+            return true;
+
+        removeFromForest (id);
+
+        uint32_t replacement = findReplacement (edges_[id].u, edges_[id].v);
+        if (replacement != NONE)
+            addToForest (replacement);
+
+        return true;
+    }
+
+    inline WeightT weight () const { return total_; }
+    inline size_t treeEdges () const { return treeEdges_; }
+    inline size_t size () const { return n_; }
+
+    bool connected (size_t u, size_t v)
+    {
+        return forest_.connected (vertexNode (u), vertexNode (v));
+    }
+
+    // Текущий лес в виде WeightedGraph
+    WeightedGraph<WeightT> forest () const
+    {
+        WeightedGraph<WeightT> result (n_);
+        for (auto [edgeKey, id]: index_)
+            if (edges_[id].node != 0)
+                result.insert (edges_[id].u, edges_[id].v, edges_[id].weight);
+        return result;
+    }
+};
+
+#endif // ! __DYNAMIC_MST_HPP__
@@ -0,0 +1,132 @@
+#ifndef __GRAPH_GENERATORS_HPP__
+#define __GRAPH_GENERATORS_HPP__
+
+/*
+ * Генераторы синтетических графов для бенчмарков. Все возвращают список рёбер (u, v, weight)
+ * с весами из [1, 1000]; для ориентированных алгоритмов ребро читается как дуга u -> v.
+ * Один и тот же seed даёт один и тот же граф.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include "WeightedGraph.hpp"
+
+using GeneratedEdges = std::vector <WeightedGraph<int>::WeightedEdge>;
+
+// Эрдёш–Реньи G(n, m): m рёбер с равновероятными концами, без петель
+inline GeneratedEdges erdosRenyiEdges (size_t n, size_t m, unsigned seed)
+{
+    std::mt19937_64 random (seed);
+    GeneratedEdges edges (m);
+    for (auto &edge: edges)
+    {
+        edge.u = random () % n;
+        do edge.v = random () % n; while (edge.v == edge.u);
+        edge.weight = 1 + random () % 1000;
+    }
+    return edges;
+}
+
+// Степенной граф (Барабаши–Альберт): каждая новая вершина соединяется с min (degree, v) уже существующими,
+// выбранными пропорционально их степени (с вероятностью 1/2 — равномерно, чтобы не было изолированных).
+// Без петель и кратных рёбер: совпавший конец выбирается заново
+inline GeneratedEdges powerLawEdges (size_t n, size_t degree, unsigned seed)
+{
+    std::mt19937_64 random (seed);
+    GeneratedEdges edges;
+    std::vector <size_t> endpoints; // вершина встречается здесь столько раз, какова её степень
+    std::vector <size_t> chosen;
+
+    for (size_t v = 1; v < n; v++)
+    {
+        chosen.clear ();
+        for (size_t i = 0; i < std::min (degree, v); i++)
+        {
+            size_t u;
+            do u = endpoints.empty () || random () % 2 ? random () % v : endpoints[random () % endpoints.size ()];
+            while (u == v || std::find (chosen.begin (), chosen.end (), u) != chosen.end ());
+
+            chosen.push_back (u);
+            edges.push_back ({u, v, (int) (1 + random () % 1000)});
+        }
+
+        // степени обновляются после выбора всех концов v, чтобы v не выбрала саму себя
+        for (size_t u: chosen)
+        {
+            endpoints.push_back (u);
+            endpoints.push_back (v);
+        }
+    }
+    return edges;
+}
+
+// R-MAT (Chakrabarti, Zhan, Faloutsos) / Graph500 Kronecker: 2^scale вершин, edgeFactor * 2^scale рёбер.
+// Каждый бит номеров концов выбирается в квадранте a / b / c / d матрицы смежности; номера вершин
+// затем перемешиваются, чтобы степень не коррелировала с номером
+inline GeneratedEdges rmatEdges (unsigned scale, size_t edgeFactor, unsigned seed,
+                                 double a = 0.57, double b = 0.19, double c = 0.19)
+{
+    std::mt19937_64 random (seed);
+    std::uniform_real_distribution <double> uniform (0.0, 1.0);
+
+    size_t n = (size_t) 1 << scale;
+    std::vector <size_t> label (n);
+    std::iota (label.begin (), label.end (), 0);
+    std::shuffle (label.begin (), label.end (), random);
+
+    GeneratedEdges edges (edgeFactor * n);
+    for (auto &edge: edges)
+    {
+        size_t u = 0, v = 0;
+        for (unsigned bit = 0; bit < scale; bit++)
+        {
+            double r = uniform (random);
+            bool down = r >= a + b;
+            bool right = (r >= a && r < a + b) || r >= a + b + c;
+            u = 2 * u + down;
+            v = 2 * v + right;
+        }
+        edge = {label[u], label[v], (int) (1 + random () % 1000)};
+    }
+    return edges;
+}
+
+// Решётка width x height: рёбра к правому и нижнему соседу
+inline GeneratedEdges gridEdges (size_t width, size_t height, unsigned seed)
+{
+    std::mt19937_64 random (seed);
+    GeneratedEdges edges;
+    for (size_t y = 0; y < height; y++)
+    for (size_t x = 0; x < width; x++)
+    {
+        size_t u = y * width + x;
+        if (x + 1 < width)  edges.push_back ({u, u + 1, (int) (1 + random () % 1000)});
+        if (y + 1 < height) edges.push_back ({u, u + width, (int) (1 + random () % 1000)});
+    }
+    return edges;
+}
+
+// Случайный DAG: m дуг, каждая идёт от меньшего номера в скрытом случайном порядке к большему
+inline GeneratedEdges randomDagEdges (size_t n, size_t m, unsigned seed)
+{
+    std::mt19937_64 random (seed);
+    std::vector <size_t> label (n);
+    std::iota (label.begin (), label.end (), 0);
+    std::shuffle (label.begin (), label.end (), random);
+
+    GeneratedEdges edges (m);
+    for (auto &edge: edges)
+    {
+        size_t u = random () % n, v;
+        do v = random () % n; while (v == u);
+        if (u > v)
+            std::swap (u, v);
+        edge = {label[u], label[v], (int) (1 + random () % 1000)};
+    }
+    return edges;
+}
+
+#endif // ! __GRAPH_GENERATORS_HPP__
@@ -0,0 +1,490 @@
+#ifndef __GRAPH_SNAPSHOT_HPP__
+#define __GRAPH_SNAPSHOT_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <span>
+#include <thread>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "CSRGraph.hpp"
+
+/*
+ * Бинарный снимок графа в формате CSR.
+ *
+ *   [0, 128)          SnapshotHeader
+ *   offsetsOffset     uint64_t offsets[vertices + 1]
+ *   targetsOffset     uint32_t targets[edges]        (соседи каждой вершины по возрастанию)
+ *   weightsOffset     WeightT  weights[edges]        (только если weightSize != 0)
+ *
+ * Все секции выровнены по 64 байтам, числа — в порядке байт машины (см. endianTag).
+ * Каждая секция и сам заголовок защищены контрольной суммой. Снимок пишется из WeightedGraph,
+ * CSRGraph или UnweightedGraph (writeSnapshot) и отображается обратно через mmap в MappedGraph
+ * без копирования: загрузка стоит O(1), страницы подтягиваются по мере обхода.
+ */
+
+struct SnapshotHeader
+{
+    char magic[8];              // "DAKGRAPH"
+    uint32_t version;
+    uint32_t endianTag;         // 0x01020304
+    uint32_t weightSize;        // 0 — невзвешенный граф
+    uint32_t weightKind;        // 0 — целый со знаком, 1 — беззнаковый, 2 — с плавающей точкой
+    uint64_t vertices, edges;
+    uint64_t offsetsOffset, targetsOffset, weightsOffset;
+    uint64_t offsetsChecksum, targetsChecksum, weightsChecksum;
+    uint64_t reserved[4];
+    uint64_t headerChecksum;    // по всем предыдущим полям
+};
+
+static_assert (sizeof (SnapshotHeader) == 128);
+
+const uint32_t SNAPSHOT_VERSION = 1;
+
+// FNV-1a по 64-битным словам: ~ГБ/с, достаточно для проверки целостности (не криптостойкость)
+inline uint64_t snapshotChecksum (const void *data, size_t bytes)
+{
+    const unsigned char *p = (const unsigned char *) data;
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    size_t words = bytes / 8;
+    for (size_t i = 0; i < words; i++)
+    {
+        uint64_t word;
+        memcpy (&word, p + 8 * i, 8);
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    for (size_t i = 8 * words; i < bytes; i++)
+        hash = (hash ^ p[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+inline uint64_t snapshotAlign (uint64_t offset)
+{
+    return (offset + 63) & ~(uint64_t) 63;
+}
+
+template <typename WeightT>
+constexpr uint32_t snapshotWeightKind ()
+{
+    return std::is_floating_point_v<WeightT> ? 2 : std::is_unsigned_v<WeightT> ? 1 : 0;
+}
+
+// Сосед из элемента getNeibs: пара (v, weight) у взвешенных графов, просто v у невзвешенных
+template <typename V, typename W>
+inline size_t snapshotTarget (const std::pair <V, W> &neib) { return neib.first; }
+inline size_t snapshotTarget (size_t neib) { return neib; }
+
+template <typename V, typename W>
+inline W snapshotWeight (const std::pair <V, W> &neib) { return neib.second; }
+
+/*
+ * Записать граф (WeightedGraph, CSRGraph, UnweightedGraph — что угодно с size () и getNeibs (u)).
+ * Соседи каждой вершины сортируются, так что порядок обхода в снимке не зависит от исходного
+ * хранилища (FlatHashSet). Возвращает false при ошибке ввода-вывода.
+ */
+template <typename Graph>
+bool writeSnapshot (const char *path, const Graph &g)
+{
+    using Neib = std::decay_t <decltype (*g.getNeibs(0).begin ())>;
+    constexpr bool WEIGHTED = !std::is_integral_v <Neib>;
+    using WeightT = typename std::conditional_t <WEIGHTED, Neib, std::pair <int, char>>::second_type;
+
+    size_t n = g.size ();
+    std::vector <uint64_t> offsets (n + 1, 0);
+    for (size_t u = 0; u < n; u++)
+    {
+        offsets[u + 1] = offsets[u] + g.getNeibs(u).size ();
+    }
+
+    uint64_t m = offsets[n];
+    if (n >= UINT32_MAX)
+        return false;
+
+    SnapshotHeader header { };
+    memcpy (header.magic, "DAKGRAPH", 8);
+    header.version = SNAPSHOT_VERSION;
+    header.endianTag = 0x01020304;
+    header.weightSize = WEIGHTED ? sizeof (WeightT) : 0;
+    header.weightKind = WEIGHTED ? snapshotWeightKind <WeightT> () : 0;
+    header.vertices = n;
+    header.edges = m;
+    header.offsetsOffset = snapshotAlign (sizeof (SnapshotHeader));
+    header.targetsOffset = snapshotAlign (header.offsetsOffset + (n + 1) * sizeof (uint64_t));
+    header.weightsOffset = WEIGHTED ? snapshotAlign (header.targetsOffset + m * sizeof (uint32_t)) : 0;
+    header.offsetsChecksum = snapshotChecksum (offsets.data (), offsets.size () * sizeof (uint64_t));
+
+    FILE *out = fopen (path, "wb");
+    if (out == nullptr)
+        return false;
+
+    // Секции собираются в памяти целиком: контрольная сумма считается по непрерывным массивам
+    std::vector <std::pair <uint32_t, WeightT>> row;
+    std::vector <uint32_t> targets;
+    std::vector <WeightT> weights;
+    targets.reserve (m);
+    if constexpr (WEIGHTED)
+        weights.reserve (m);
+
+    for (size_t u = 0; u < n; u++)
+    {
+        row.clear ();
+        for (auto neib: g.getNeibs(u))
+        {
+            if constexpr (WEIGHTED)
+                row.push_back ({(uint32_t) snapshotTarget (neib), snapshotWeight (neib)});
+            else
+                row.push_back ({(uint32_t) snapshotTarget (neib), WeightT { }});
+        }
+        std::sort (row.begin (), row.end (), [] (const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+        for (auto &[v, weight]: row)
+        {
+            targets.push_back (v);
+            if constexpr (WEIGHTED)
+                weights.push_back (weight);
+        }
+    }
+
+    header.targetsChecksum = snapshotChecksum (targets.data (), m * sizeof (uint32_t));
+    if constexpr (WEIGHTED)
+        header.weightsChecksum = snapshotChecksum (weights.data (), m * sizeof (WeightT));
+    header.headerChecksum = snapshotChecksum (&header, offsetof (SnapshotHeader, headerChecksum));
+
+    auto writeAt = [&] (uint64_t offset, const void *data, size_t bytes) {
+        return fseeko (out, (off_t) offset, SEEK_SET) == 0 && fwrite (data, 1, bytes, out) == bytes;
+    };
+
+    bool ok = writeAt (0, &header, sizeof (header))
+           && writeAt (header.offsetsOffset, offsets.data (), offsets.size () * sizeof (uint64_t))
+           && writeAt (header.targetsOffset, targets.data (), m * sizeof (uint32_t));
+    if constexpr (WEIGHTED)
+        ok = ok && writeAt (header.weightsOffset, weights.data (), m * sizeof (WeightT));
+
+    ok = fclose (out) == 0 && ok;
+    return ok;
+}
+
+/*
+ * Граф только для чтения поверх mmap снимка. WeightT = void — невзвешенный снимок,
+ * getNeibs (u) даёт номера соседей (как UnweightedGraph); иначе — пары (v, weight), как CSRGraph.
+ * open () проверяет заголовок, тип весов, что секции лежат в файле по порядку, не пересекаясь,
+ * и выровнены, и массив смещений (неубывает, offsets[0] = 0, offsets[n] = m — читается только он,
+ * n + 1 чисел), так что обход не выйдет за секцию целевых вершин.
+ * verify = true дополнительно сверяет контрольные суммы секций и что все цели < n (читает весь файл);
+ * без него номера соседей не проверяются, и повреждённый файл правильного размера может дать
+ * номер вершины вне [0, n) — для файлов из ненадёжных источников нужен verify.
+ */
+template <typename WeightT = void>
+class MappedGraph
+{
+    static constexpr bool WEIGHTED = !std::is_void_v <WeightT>;
+
+    void *map_;
+    size_t mapSize_;
+    const SnapshotHeader *header_;
+    const uint64_t *offsets_;
+    const uint32_t *targets_;
+    const std::conditional_t <WEIGHTED, WeightT, char> *weights_;
+    const char *error_;
+
+    bool fail (const char *error)
+    {
+        close ();
+        error_ = error;
+        return false;
+    }
+
+public:
+
+    MappedGraph ():
+        map_ (nullptr), mapSize_ (0),
+        header_ (nullptr), offsets_ (nullptr), targets_ (nullptr), weights_ (nullptr),
+        error_ (nullptr)
+    {}
+
+    MappedGraph (const MappedGraph &) = delete;
+    MappedGraph &operator= (const MappedGraph &) = delete;
+
+    ~MappedGraph ()
+    {
+        close ();
+    }
+
+    bool open (const char *path, bool verify = false)
+    {
+        close ();
+
+        int fd = ::open (path, O_RDONLY);
+        if (fd < 0)
+            return fail ("cannot open file");
+
+        struct stat st;
+        if (fstat (fd, &st) != 0 || (size_t) st.st_size < sizeof (SnapshotHeader))
+        {
+            ::close (fd);
+            return fail ("file too short");
+        }
+
+        mapSize_ = st.st_size;
+        map_ = mmap (nullptr, mapSize_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close (fd);
+        if (map_ == MAP_FAILED)
+        {
+            map_ = nullptr;
+            return fail ("mmap failed");
+        }
+
+        const char *base = (const char *) map_;
+        header_ = (const SnapshotHeader *) base;
+
+        if (memcmp (header_->magic, "DAKGRAPH", 8) != 0)
+            return fail ("not a graph snapshot");
+        if (header_->headerChecksum != snapshotChecksum (header_, offsetof (SnapshotHeader, headerChecksum)))
+            return fail ("header checksum mismatch");
+        if (header_->version != SNAPSHOT_VERSION)
+            return fail ("unsupported snapshot version");
+        if (header_->endianTag != 0x01020304)
+            return fail ("snapshot written with different byte order");
+
+        if constexpr (WEIGHTED)
+        {
+            if (header_->weightSize != sizeof (WeightT) || header_->weightKind != snapshotWeightKind <WeightT> ())
+                return fail ("weight type mismatch");
+        }
+        else if (header_->weightSize != 0)
+            return fail ("weighted snapshot opened as unweighted");
+
+        // секция [offset, offset + count * size) целиком в файле; без переполнений при любых полях заголовка
+        auto fits = [this] (uint64_t offset, uint64_t count, uint64_t size)
+        {
+            return offset <= mapSize_ && count <= (mapSize_ - offset) / size;
+        };
+
+        uint64_t n = header_->vertices, m = header_->edges;
+        uint64_t offsetsOffset = header_->offsetsOffset, targetsOffset = header_->targetsOffset;
+        uint64_t weightsOffset = header_->weightsOffset, weightSize = header_->weightSize;
+        if (n >= mapSize_ / sizeof (uint64_t)
+         || !fits (offsetsOffset, n + 1, sizeof (uint64_t)) || !fits (targetsOffset, m, sizeof (uint32_t))
+         || (WEIGHTED && !fits (weightsOffset, m, weightSize)))
+            return fail ("file truncated");
+        if (offsetsOffset < sizeof (SnapshotHeader)
+         || offsetsOffset + (n + 1) * sizeof (uint64_t) > targetsOffset
+         || (WEIGHTED && targetsOffset + m * sizeof (uint32_t) > weightsOffset))
+            return fail ("sections overlap");
+        if (offsetsOffset % alignof (uint64_t) != 0 || targetsOffset % alignof (uint32_t) != 0
+         || (WEIGHTED && weightsOffset % weightSize != 0))
+            return fail ("sections misaligned");
+
+        offsets_ = (const uint64_t *) (base + offsetsOffset);
+        targets_ = (const uint32_t *) (base + targetsOffset);
+        if constexpr (WEIGHTED)
+            weights_ = (const WeightT *) (base + weightsOffset);
+
+        if (offsets_[0] != 0 || offsets_[n] != m)
+            return fail ("offsets do not match edge count");
+        for (uint64_t u = 0; u < n; u++)
+            if (offsets_[u] > offsets_[u + 1])
+                return fail ("offsets not monotone");
+
+        if (verify)
+        {
+            if (snapshotChecksum (offsets_, (n + 1) * sizeof (uint64_t)) != header_->offsetsChecksum
+             || snapshotChecksum (targets_, m * sizeof (uint32_t)) != header_->targetsChecksum
+             || (WEIGHTED && snapshotChecksum (weights_, m * header_->weightSize) != header_->weightsChecksum))
+                return fail ("section checksum mismatch");
+            for (uint64_t i = 0; i < m; i++)
+                if (targets_[i] >= n)
+                    return fail ("target vertex out of range");
+        }
+
+        // последовательный обход — основной сценарий
+        madvise (map_, mapSize_, MADV_SEQUENTIAL);
+        error_ = nullptr;
+        return true;
+    }
+
+    void close ()
+    {
+        if (map_)
+            munmap (map_, mapSize_);
+        map_ = nullptr;
+        mapSize_ = 0;
+        header_ = nullptr;
+        offsets_ = nullptr;
+        targets_ = nullptr;
+        weights_ = nullptr;
+    }
+
+    inline const char *error () const { return error_; }
+
+    inline size_t size () const { return header_ ? header_->vertices : 0; }
+    inline size_t edgeCount () const { return header_ ? header_->edges : 0; }
+    inline size_t degree (size_t u) const { return offsets_[u + 1] - offsets_[u]; }
+
+    auto getNeibs (size_t u) const
+    {
+        if constexpr (WEIGHTED)
+            return typename CSRGraph<WeightT>::NeibRange (targets_ + offsets_[u], weights_ + offsets_[u], degree (u));
+        else
+            return std::span <const uint32_t> (targets_ + offsets_[u], degree (u));
+    }
+
+    bool contains (size_t u, size_t v) const
+    {
+        const uint32_t *first = targets_ + offsets_[u], *last = targets_ + offsets_[u + 1];
+        return std::binary_search (first, last, (uint32_t) v);
+    }
+};
+
+/*
+ * Параллельный разбор текстового списка рёбер: строки "u v" или "u v weight", строки с '#' и '%' —
+ * комментарии. Файл отображается в память и режется на threads кусков по границам строк.
+ * vertices — максимальный номер вершины + 1. Рёбра идут в том же порядке, что и в файле.
+ */
+template <typename WeightT>
+struct EdgeList
+{
+    size_t vertices = 0;
+    std::vector <typename WeightedGraph<WeightT>::WeightedEdge> edges;
+    bool ok = false;
+};
+
+template <typename WeightT>
+EdgeList<WeightT> importEdgeList (const char *path, unsigned threads = std::thread::hardware_concurrency ())
+{
+    using edge_t = typename WeightedGraph<WeightT>::WeightedEdge;
+    EdgeList<WeightT> result;
+
+    int fd = ::open (path, O_RDONLY);
+    if (fd < 0)
+        return result;
+
+    struct stat st;
+    if (fstat (fd, &st) != 0)
+    {
+        ::close (fd);
+        return result;
+    }
+
+    size_t size = st.st_size;
+    const char *text = size ? (const char *) mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : "";
+    ::close (fd);
+    if (text == MAP_FAILED)
+        return result;
+
+    if (threads == 0)
+        threads = 1;
+
+    // границы кусков сдвигаются к началу следующей строки
+    std::vector <size_t> bounds (threads + 1, size);
+    bounds[0] = 0;
+    for (unsigned t = 1; t < threads; t++)
+    {
+        size_t pos = std::max (bounds[t - 1], size / threads * t);
+        while (pos < size && pos > 0 && text[pos - 1] != '\n')
+            pos++;
+        bounds[t] = pos;
+    }
+
+    std::vector <std::vector <edge_t>> parts (threads);
+    std::vector <size_t> maxVertex (threads, 0);
+    std::vector <bool> partOk (threads, true);
+
+    auto parse = [&] (unsigned t) {
+        const char *p = text + bounds[t], *end = text + bounds[t + 1];
+
+        auto skipSpaces = [&] { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++; };
+        auto readUnsigned = [&] (uint64_t &value) {
+            skipSpaces ();
+            if (p == end || *p < '0' || *p > '9')
+                return false;
+            value = 0;
+            while (p < end && *p >= '0' && *p <= '9')
+                value = value * 10 + (*p++ - '0');
+            return true;
+        };
+
+        while (p < end)
+        {
+            skipSpaces ();
+            if (p < end && (*p == '#' || *p == '%' || *p == '\n'))
+            {
+                while (p < end && *p++ != '\n');
+                continue;
+            }
+            if (p == end)
+                break;
+
+            uint64_t u, v;
+            if (!readUnsigned (u) || !readUnsigned (v))
+            {
+                partOk[t] = false;
+                return;
+            }
+
+            skipSpaces ();
+            WeightT weight = (WeightT) 1;
+            if (p < end && *p != '\n')
+            {
+                // отображение не завершается нулём, поэтому strtod получает копию лексемы
+                char token[64];
+                size_t length = 0;
+                while (p < end && length + 1 < sizeof (token) && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                    token[length++] = *p++;
+                token[length] = '\0';
+
+                char *stop;
+                if constexpr (std::is_floating_point_v <WeightT>)
+                    weight = (WeightT) strtod (token, &stop);
+                else
+                    weight = (WeightT) strtoll (token, &stop, 10);
+                if (stop == token || *stop != '\0')
+                {
+                    partOk[t] = false;
+                    return;
+                }
+            }
+            while (p < end && *p++ != '\n');
+
+            parts[t].push_back ({(size_t) u, (size_t) v, weight});
+            maxVertex[t] = std::max <size_t> (maxVertex[t], std::max (u, v) + 1);
+        }
+    };
+
+    std::vector <std::thread> workers;
+    for (unsigned t = 1; t < threads; t++)
+        workers.emplace_back (parse, t);
+    parse (0);
+    for (auto &worker: workers)
+        worker.join ();
+
+    if (size)
+        munmap ((void *) text, size);
+
+    size_t total = 0;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        if (!partOk[t])
+            return result;
+        total += parts[t].size ();
+        result.vertices = std::max (result.vertices, maxVertex[t]);
+    }
+
+    result.edges.reserve (total);
+    for (auto &part: parts)
+        result.edges.insert (result.edges.end (), part.begin (), part.end ());
+    result.ok = true;
+    return result;
+}
+
+#endif // ! __GRAPH_SNAPSHOT_HPP__
@@ -0,0 +1,636 @@
+#ifndef __HUFFMAN_HPP__
+#define __HUFFMAN_HPP__
+
+/*
+ * Канонический код Хаффмана для байтового алфавита.
+ *
+ * Длины кодов ограничены MAX_CODE_BITS; по длинам строятся канонические коды (по возрастанию
+ * длины, при равной — по символу), так что для передачи кода достаточно длин.
+ * Поток бит — младшими битами вперёд, коды записываются в обратном порядке бит: тогда
+ * очередной код — младшие биты 64-битного буфера, и декодер берёт их одной маской.
+ * Декодер — таблица на DECODE_TABLE_BITS бит, одна запись которой содержит до трёх символов.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+const unsigned MAX_CODE_BITS = 15;
+const unsigned DECODE_TABLE_BITS = 12;
+const unsigned ALPHABET_SIZE = 256;
+
+// Длины кодов Хаффмана на месте (Moffat, Katajainen): weights отсортированы по возрастанию,
+// на выходе weights[i] — длина кода i-го веса (невозрастающие). O(n), без узлов дерева.
+// Первый проход сливает веса и внутренние узлы как две очереди, сохраняя в освободившихся
+// ячейках ссылки на родителей; второй — глубины внутренних узлов; третий — глубины листьев
+inline void minimumRedundancyLengths (uint64_t *weights, size_t n)
+{
+    if (n == 0)
+        return;
+    if (n == 1)
+    {
+        weights[0] = 0;
+        return;
+    }
+
+    uint64_t *a = weights;
+    size_t root = 0, leaf = 2;
+    a[0] += a[1];
+    for (size_t next = 1; next < n - 1; next++)
+    {
+        if (leaf >= n || a[root] < a[leaf])
+        {
+            a[next] = a[root];
+            a[root++] = next;
+        }
+        else
+            a[next] = a[leaf++];
+
+        if (leaf >= n || (root < next && a[root] < a[leaf]))
+        {
+            a[next] += a[root];
+            a[root++] = next;
+        }
+        else
+            a[next] += a[leaf++];
+    }
+
+    a[n - 2] = 0;
+    for (size_t next = n - 2; next-- > 0;)
+        a[next] = a[a[next]] + 1;
+
+    int64_t internal = (int64_t) n - 2, next = (int64_t) n - 1;
+    uint64_t available = 1, used = 0, depth = 0;
+    while (available > 0)
+    {
+        while (internal >= 0 && a[internal] == depth)
+        {
+            used++;
+            internal--;
+        }
+        while (available > used)
+        {
+            a[next--] = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+}
+
+// Поразрядная сортировка пар (частота, символ) по частоте, по байту за проход. Устойчива: при равных
+// частотах сохраняется исходный порядок. Байты, одинаковые у всех частот, пропускаются
+inline void radixSortByFrequency (std::vector <std::pair <uint64_t, uint32_t>> &items)
+{
+    size_t count[8][256] = {};
+    for (auto &item: items)
+        for (unsigned digit = 0; digit < 8; digit++)
+            count[digit][(item.first >> (8 * digit)) & 0xFF]++;
+
+    std::vector <std::pair <uint64_t, uint32_t>> buffer (items.size ());
+    for (unsigned digit = 0; digit < 8; digit++)
+    {
+        unsigned shift = 8 * digit;
+        if (count[digit][(items[0].first >> shift) & 0xFF] == items.size ())
+            continue;
+
+        for (size_t bucket = 0, pos = 0; bucket < 256; bucket++)
+            pos += std::exchange (count[digit][bucket], pos);
+        for (auto &item: items)
+            buffer[count[digit][(item.first >> shift) & 0xFF]++] = item;
+        items.swap (buffer);
+    }
+}
+
+// Длины кодов Хаффмана для частот freq (нулевая частота — длина 0), не длиннее maxBits;
+// используемых символов не больше 2^maxBits. Единственный используемый символ получает длину 1.
+// Частоты сортируются один раз (поразрядно), дальше всё линейно — годится для алфавитов до 2^20 и больше.
+// Ограничение длины: переполнившие листья опускаются на maxBits, место под них освобождается
+// удлинением самых длинных из коротких кодов; затем длины раздаются по убыванию частоты
+inline std::vector <uint8_t> codeLengths (const std::vector <uint64_t> &freq, unsigned maxBits = MAX_CODE_BITS)
+{
+    // (частота, символ) рядом в памяти: сортировка не ходит по freq случайно
+    std::vector <std::pair <uint64_t, uint32_t>> symbols;
+    for (uint32_t sym = 0; sym < freq.size (); sym++)
+        if (freq[sym] > 0)
+            symbols.push_back ({freq[sym], sym});
+
+    std::vector <uint8_t> lengths (freq.size (), 0);
+    size_t n = symbols.size ();
+    if (n == 1)
+        lengths[symbols[0].second] = 1;
+    if (n <= 1)
+        return lengths;
+
+    // символы уже по возрастанию: при равных частотах порядок по символу
+    if (n < 1024)
+        std::sort (symbols.begin (), symbols.end ());
+    else
+        radixSortByFrequency (symbols);
+
+    std::vector <uint64_t> sorted (n);
+    for (size_t i = 0; i < n; i++)
+        sorted[i] = symbols[i].first;
+    minimumRedundancyLengths (sorted.data (), n);
+
+    // sorted[0] — самый длинный код
+    if (sorted[0] > maxBits)
+    {
+        std::vector <uint64_t> count (maxBits + 1, 0);
+        for (uint64_t length: sorted)
+            count[std::min <uint64_t> (length, maxBits)]++;
+
+        uint64_t kraft = 0;
+        for (unsigned bits = 1; bits <= maxBits; bits++)
+            kraft += count[bits] << (maxBits - bits);
+
+        for (; kraft > (uint64_t) 1 << maxBits; kraft--)
+        {
+            unsigned bits = maxBits - 1;
+            while (count[bits] == 0)
+                bits--;
+            count[bits]--;
+            count[bits + 1] += 2;
+            count[maxBits]--;
+        }
+
+        size_t next = n;
+        for (unsigned bits = 1; bits <= maxBits; bits++)
+            for (uint64_t i = 0; i < count[bits]; i++)
+                sorted[--next] = bits;
+    }
+
+    for (size_t i = 0; i < n; i++)
+        lengths[symbols[i].second] = (uint8_t) sorted[i];
+    return lengths;
+}
+
+// Канонические коды по длинам; codes[sym] — код с обратным порядком бит (для записи младшими вперёд)
+inline std::vector <uint16_t> canonicalCodes (const std::vector <uint8_t> &lengths)
+{
+    uint32_t count[MAX_CODE_BITS + 1] = {}, next[MAX_CODE_BITS + 2] = {};
+    for (uint8_t length: lengths)
+        count[length]++;
+    count[0] = 0;
+
+    for (unsigned bits = 1; bits <= MAX_CODE_BITS; bits++)
+        next[bits + 1] = (next[bits] + count[bits]) << 1;
+
+    std::vector <uint16_t> codes (lengths.size (), 0);
+    for (size_t sym = 0; sym < lengths.size (); sym++)
+        if (unsigned length = lengths[sym])
+        {
+            uint32_t code = next[length]++, reversed = 0;
+            for (unsigned bit = 0; bit < length; bit++)
+                reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+            codes[sym] = (uint16_t) reversed;
+        }
+    return codes;
+}
+
+class BitWriter
+{
+    std::vector <uint8_t> &out_;
+    size_t pos_;
+    uint64_t buffer_;
+    unsigned bits_;
+
+public:
+
+    // Дописывает в конец out; reserveBits — верхняя оценка числа бит
+    BitWriter (std::vector <uint8_t> &out, uint64_t reserveBits):
+        out_ (out), pos_ (out.size ()), buffer_ (0), bits_ (0)
+    {
+        out_.resize (pos_ + reserveBits / 8 + 16);
+    }
+
+    // length <= 15; между flush — не больше 56 бит
+    inline void put (uint32_t code, unsigned length)
+    {
+        buffer_ |= (uint64_t) code << bits_;
+        bits_ += length;
+    }
+
+    inline void flush ()
+    {
+        std::memcpy (out_.data () + pos_, &buffer_, 8);
+        pos_ += bits_ >> 3;
+        buffer_ >>= bits_ & ~7u;
+        bits_ &= 7;
+    }
+
+    // Дописать неполный байт и обрезать out
+    void finish ()
+    {
+        flush ();
+        out_[pos_] = (uint8_t) buffer_;
+        out_.resize (pos_ + (bits_ ? 1 : 0));
+    }
+};
+
+class BitReader
+{
+    const uint8_t *data_;
+    size_t size_, pos_;
+    uint64_t buffer_;
+    unsigned bits_;
+
+public:
+
+    BitReader (const uint8_t *data, size_t size):
+        data_ (data), size_ (size), pos_ (0), buffer_ (0), bits_ (0)
+    {}
+
+    // После refill в буфере не меньше 56 бит; за концом данных — нули
+    inline void refill ()
+    {
+        if (pos_ + 8 <= size_)
+        {
+            uint64_t word;
+            std::memcpy (&word, data_ + pos_, 8);
+            buffer_ |= word << bits_;
+            pos_ += (63 - bits_) >> 3;
+            bits_ |= 56;
+        }
+        else
+            for (; bits_ <= 56; bits_ += 8, pos_++)
+                buffer_ |= (uint64_t) (pos_ < size_ ? data_[pos_] : 0) << bits_;
+    }
+
+    inline uint32_t peek (unsigned count) const
+    {
+        return (uint32_t) (buffer_ & (((uint64_t) 1 << count) - 1));
+    }
+
+    inline void consume (unsigned count)
+    {
+        buffer_ >>= count;
+        bits_ -= count;
+    }
+
+    // Прочитано не больше, чем есть данных
+    inline bool valid () const
+    {
+        return pos_ * 8 - bits_ <= size_ * 8;
+    }
+};
+
+class HuffmanDecoder
+{
+    // single_: символ | длина << 8, длина 0 — код длиннее DECODE_TABLE_BITS или не существует.
+    // multi_: до трёх символов | число символов << 24 | число бит << 26
+    std::vector <uint16_t> single_;
+    std::vector <uint32_t> multi_;
+
+    // канонический разбор для длинных кодов
+    uint32_t count_[MAX_CODE_BITS + 1] = {}, first_[MAX_CODE_BITS + 1] = {}, offset_[MAX_CODE_BITS + 1] = {};
+    std::vector <uint8_t> sorted_;
+
+    // -1 — неверный код
+    int decodeSlow (BitReader &reader) const
+    {
+        uint32_t code = 0;
+        for (unsigned bits = 1; bits <= MAX_CODE_BITS; bits++)
+        {
+            code = code << 1 | reader.peek (1);
+            reader.consume (1);
+            if (code - first_[bits] < count_[bits])
+                return sorted_[offset_[bits] + code - first_[bits]];
+        }
+        return -1;
+    }
+
+public:
+
+    explicit HuffmanDecoder (const std::vector <uint8_t> &lengths):
+        single_ (1u << DECODE_TABLE_BITS, 0), multi_ (1u << DECODE_TABLE_BITS, 0)
+    {
+        const uint32_t MASK = (1u << DECODE_TABLE_BITS) - 1;
+        std::vector <uint16_t> codes = canonicalCodes (lengths);
+
+        for (uint8_t length: lengths)
+            count_[length]++;
+        count_[0] = 0;
+        for (unsigned bits = 1, code = 0, offset = 0; bits <= MAX_CODE_BITS; bits++)
+        {
+            first_[bits] = code;
+            offset_[bits] = offset;
+            code = (code + count_[bits]) << 1;
+            offset += count_[bits];
+        }
+        for (unsigned bits = 1; bits <= MAX_CODE_BITS; bits++)
+            for (size_t sym = 0; sym < lengths.size (); sym++)
+                if (lengths[sym] == bits)
+                    sorted_.push_back ((uint8_t) sym);
+
+        for (size_t sym = 0; sym < lengths.size (); sym++)
+        {
+            unsigned length = lengths[sym];
+            if (length == 0 || length > DECODE_TABLE_BITS)
+                continue;
+            for (uint32_t fill = 0; fill < (1u << (DECODE_TABLE_BITS - length)); fill++)
+                single_[codes[sym] | fill << length] = (uint16_t) (sym | length << 8);
+        }
+
+        for (uint32_t index = 0; index <= MASK; index++)
+        {
+            uint32_t entry = 0, symbols = 0, used = 0;
+            while (symbols < 3)
+            {
+                uint16_t next = single_[(index >> used) & MASK];
+                unsigned length = next >> 8;
+                if (length == 0 || used + length > DECODE_TABLE_BITS)
+                    break;
+                entry |= (uint32_t) (next & 0xFF) << (8 * symbols);
+                symbols++;
+                used += length;
+            }
+            multi_[index] = entry | symbols << 24 | used << 26;
+        }
+    }
+
+    // Декодировать count символов; false — поток повреждён
+    bool decode (const uint8_t *data, size_t size, uint8_t *out, size_t count) const
+    {
+        const uint32_t MASK = (1u << DECODE_TABLE_BITS) - 1;
+        BitReader reader (data, size);
+        uint8_t *end = out + count;
+
+        // 4 обращения к таблице по <= 12 бит укладываются в 56 бит одной подкачки (длинный код —
+        // до 15 бит, после него подкачка); запись по 4 байта требует запаса в 16 байт до конца
+        while (end - out >= 16)
+        {
+            reader.refill ();
+            for (int step = 0; step < 4; step++)
+            {
+                uint32_t entry = multi_[reader.peek (DECODE_TABLE_BITS)];
+                uint32_t symbols = (entry >> 24) & 3;
+                if (symbols == 0)
+                {
+                    int sym = decodeSlow (reader);
+                    if (sym < 0)
+                        return false;
+                    *out++ = (uint8_t) sym;
+                    break;
+                }
+                std::memcpy (out, &entry, 4);
+                out += symbols;
+                reader.consume (entry >> 26);
+            }
+        }
+
+        while (out < end)
+        {
+            reader.refill ();
+            uint16_t next = single_[reader.peek (DECODE_TABLE_BITS) & MASK];
+            if (next >> 8)
+            {
+                *out++ = (uint8_t) next;
+                reader.consume (next >> 8);
+                continue;
+            }
+            int sym = decodeSlow (reader);
+            if (sym < 0)
+                return false;
+            *out++ = (uint8_t) sym;
+        }
+
+        return reader.valid ();
+    }
+};
+
+// Частоты байтов. Четыре таблицы счётчиков: подряд идущие одинаковые байты попадают в разные
+// таблицы, и инкремент не ждёт сохранения предыдущего через store-to-load forwarding
+inline std::vector <uint64_t> byteFrequencies (const uint8_t *data, size_t size)
+{
+    const size_t CHUNK = (size_t) 1 << 30;      // счётчики uint32 не переполняются
+    std::vector <uint64_t> freq (ALPHABET_SIZE, 0);
+
+    for (size_t start = 0; start < size; start += CHUNK)
+    {
+        uint32_t tables[4][ALPHABET_SIZE] = {};
+        const uint8_t *p = data + start, *end = data + std::min (size, start + CHUNK);
+
+        for (; p + 4 <= end; p += 4)
+        {
+            uint32_t word;
+            std::memcpy (&word, p, 4);
+            tables[0][word & 0xFF]++;
+            tables[1][(word >> 8) & 0xFF]++;
+            tables[2][(word >> 16) & 0xFF]++;
+            tables[3][word >> 24]++;
+        }
+        for (; p < end; p++)
+            tables[0][*p]++;
+
+        for (unsigned sym = 0; sym < ALPHABET_SIZE; sym++)
+            freq[sym] += (uint64_t) tables[0][sym] + tables[1][sym] + tables[2][sym] + tables[3][sym];
+    }
+    return freq;
+}
+
+// Дописать в out поток кодов data по длинам lengths
+inline void huffmanEncode (const uint8_t *data, size_t size, const std::vector <uint8_t> &lengths, std::vector <uint8_t> &out)
+{
+    std::vector <uint16_t> codes = canonicalCodes (lengths);
+
+    // длина и код в одной записи: одна загрузка на символ
+    uint32_t table[ALPHABET_SIZE];
+    for (unsigned sym = 0; sym < ALPHABET_SIZE; sym++)
+        table[sym] = codes[sym] | (uint32_t) lengths[sym] << 16;
+
+    BitWriter writer (out, (uint64_t) size * MAX_CODE_BITS);
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3)
+    {
+        // 3 кода по <= 15 бит + остаток < 8 бит помещаются в 64-битный буфер
+        writer.put (table[data[i]] & 0xFFFF, table[data[i]] >> 16);
+        writer.put (table[data[i + 1]] & 0xFFFF, table[data[i + 1]] >> 16);
+        writer.put (table[data[i + 2]] & 0xFFFF, table[data[i + 2]] >> 16);
+        writer.flush ();
+    }
+    for (; i < size; i++)
+    {
+        writer.put (table[data[i]] & 0xFFFF, table[data[i]] >> 16);
+        writer.flush ();
+    }
+    writer.finish ();
+}
+
+// Формат: размер (8 байт), длины кодов по 4 бита (128 байт), поток кодов
+inline std::vector <uint8_t> huffmanCompress (const uint8_t *data, size_t size)
+{
+    std::vector <uint8_t> lengths = codeLengths (byteFrequencies (data, size));
+
+    std::vector <uint8_t> out (8 + ALPHABET_SIZE / 2);
+    uint64_t size64 = size;
+    std::memcpy (out.data (), &size64, 8);
+    for (unsigned sym = 0; sym < ALPHABET_SIZE; sym += 2)
+        out[8 + sym / 2] = (uint8_t) (lengths[sym] | lengths[sym + 1] << 4);
+
+    huffmanEncode (data, size, lengths, out);
+    return out;
+}
+
+inline bool huffmanDecompress (const uint8_t *data, size_t size, std::vector <uint8_t> &out)
+{
+    const size_t HEADER_SIZE = 8 + ALPHABET_SIZE / 2;
+    if (size < HEADER_SIZE)
+        return false;
+
+    uint64_t count;
+    std::memcpy (&count, data, 8);
+
+    std::vector <uint8_t> lengths (ALPHABET_SIZE);
+    for (unsigned sym = 0; sym < ALPHABET_SIZE; sym += 2)
+    {
+        lengths[sym] = data[8 + sym / 2] & 0xF;
+        lengths[sym + 1] = data[8 + sym / 2] >> 4;
+    }
+
+    // длины должны задавать префиксный код
+    uint64_t kraft = 0;
+    for (uint8_t length: lengths)
+        if (length)
+            kraft += (uint64_t) 1 << (MAX_CODE_BITS - length);
+    if (kraft > (uint64_t) 1 << MAX_CODE_BITS || (kraft == 0 && count > 0) || count > (size - HEADER_SIZE) * 8)
+        return false;
+
+    out.resize (count);
+    return HuffmanDecoder (lengths).decode (data + HEADER_SIZE, size - HEADER_SIZE, out.data (), count);
+}
+
+/*
+ * Блоки для потокового сжатия: каждый блок декодируется независимо.
+ * Заголовок блока — исходный размер (4 байта), размер данных (4 байта), режим (1 байт).
+ * Данные блока BLOCK_HUFFMAN — таблица длин (маска используемых символов, 32 байта, и их длины
+ * по 4 бита) и поток кодов; BLOCK_STORED — байты как есть, если код не даёт выигрыша.
+ * Блок с исходным размером 0 завершает поток.
+ */
+enum BlockMode: uint8_t
+{
+    BLOCK_STORED = 0,
+    BLOCK_HUFFMAN = 1
+};
+
+const size_t BLOCK_HEADER_SIZE = 9;
+const size_t MAX_BLOCK_SIZE = (size_t) 1 << 28;
+
+struct BlockHeader
+{
+    uint32_t rawSize;
+    uint32_t packedSize;
+    BlockMode mode;
+};
+
+inline void writeBlockHeader (const BlockHeader &header, uint8_t *out)
+{
+    std::memcpy (out, &header.rawSize, 4);
+    std::memcpy (out + 4, &header.packedSize, 4);
+    out[8] = header.mode;
+}
+
+inline bool readBlockHeader (const uint8_t *data, BlockHeader &header)
+{
+    std::memcpy (&header.rawSize, data, 4);
+    std::memcpy (&header.packedSize, data + 4, 4);
+    header.mode = (BlockMode) data[8];
+
+    if (header.rawSize > MAX_BLOCK_SIZE || header.packedSize > MAX_BLOCK_SIZE + BLOCK_HEADER_SIZE + ALPHABET_SIZE)
+        return false;
+    if (header.mode == BLOCK_STORED)
+        return header.packedSize == header.rawSize;
+    return header.mode == BLOCK_HUFFMAN;
+}
+
+inline void writeCodeLengths (const std::vector <uint8_t> &lengths, std::vector <uint8_t> &out)
+{
+    size_t mask = out.size ();
+    out.resize (mask + ALPHABET_SIZE / 8, 0);
+
+    uint8_t pending = 0;
+    bool half = false;
+    for (unsigned sym = 0; sym < ALPHABET_SIZE; sym++)
+        if (lengths[sym])
+        {
+            out[mask + sym / 8] |= (uint8_t) (1 << (sym % 8));
+            if (half)
+                out.push_back ((uint8_t) (pending | lengths[sym] << 4));
+            else
+                pending = lengths[sym];
+            half = !half;
+        }
+    if (half)
+        out.push_back (pending);
+}
+
+// Возвращает число прочитанных байт, 0 — ошибка
+inline size_t readCodeLengths (const uint8_t *data, size_t size, std::vector <uint8_t> &lengths)
+{
+    if (size < ALPHABET_SIZE / 8)
+        return 0;
+
+    lengths.assign (ALPHABET_SIZE, 0);
+    size_t pos = ALPHABET_SIZE / 8;
+    bool half = false;
+    for (unsigned sym = 0; sym < ALPHABET_SIZE; sym++)
+        if (data[sym / 8] >> (sym % 8) & 1)
+        {
+            if (pos >= size)
+                return 0;
+            lengths[sym] = half ? data[pos++] >> 4 : data[pos] & 0xF;
+            if (!lengths[sym])
+                return 0;
+            half = !half;
+        }
+    if (half)
+        pos++;
+
+    uint64_t kraft = 0;
+    for (uint8_t length: lengths)
+        if (length)
+            kraft += (uint64_t) 1 << (MAX_CODE_BITS - length);
+    return kraft <= (uint64_t) 1 << MAX_CODE_BITS ? pos : 0;
+}
+
+// Дописать в out сжатый блок data[0, size), 0 < size <= MAX_BLOCK_SIZE
+inline void compressBlock (const uint8_t *data, size_t size, std::vector <uint8_t> &out)
+{
+    size_t start = out.size ();
+    out.resize (start + BLOCK_HEADER_SIZE);
+
+    std::vector <uint8_t> lengths = codeLengths (byteFrequencies (data, size));
+    writeCodeLengths (lengths, out);
+    huffmanEncode (data, size, lengths, out);
+
+    BlockHeader header {(uint32_t) size, (uint32_t) (out.size () - start - BLOCK_HEADER_SIZE), BLOCK_HUFFMAN};
+    if (header.packedSize >= size)
+    {
+        header = {(uint32_t) size, (uint32_t) size, BLOCK_STORED};
+        out.resize (start + BLOCK_HEADER_SIZE);
+        out.insert (out.end (), data, data + size);
+    }
+    writeBlockHeader (header, out.data () + start);
+}
+
+// Распаковать данные блока (после заголовка) в out[0, header.rawSize)
+inline bool decompressBlock (const BlockHeader &header, const uint8_t *data, uint8_t *out)
+{
+    if (header.mode == BLOCK_STORED)
+    {
+        std::memcpy (out, data, header.rawSize);
+        return true;
+    }
+
+    std::vector <uint8_t> lengths;
+    size_t tableSize = readCodeLengths (data, header.packedSize, lengths);
+    if (tableSize == 0 || header.rawSize > (header.packedSize - tableSize) * (uint64_t) 8)
+        return false;
+
+    return HuffmanDecoder (lengths).decode (data + tableSize, header.packedSize - tableSize, out, header.rawSize);
+}
+
+#endif // ! __HUFFMAN_HPP__
@@ -0,0 +1,150 @@
+#ifndef __INDEXED_HEAP_HPP__
+#define __INDEXED_HEAP_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <cassert>
+
+/*
+ * Индексированная D-арная min-куча над вершинами 0..n-1 с операцией decrease-key.
+ * Ключи лежат в непрерывном массиве keys_[v], в самой куче — только 32-битные номера вершин,
+ * pos_[v] — позиция v в куче (NOT_IN_HEAP, если её там нет).
+ * clear () стоит O(размер кучи), а не O(n), так что одну кучу можно переиспользовать между запросами.
+ */
+template <typename KeyT, unsigned D = 2>
+class IndexedHeap
+{
+    static_assert (D >= 2);
+
+    std::vector <KeyT> keys_;
+    std::vector <uint32_t> heap_;
+    std::vector <uint32_t> pos_;
+
+    static constexpr uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+    void place (size_t i, uint32_t v)
+    {
+        heap_[i] = v;
+        pos_[v] = (uint32_t) i;
+    }
+
+    void siftUp (size_t i)
+    {
+        uint32_t v = heap_[i];
+        while (i > 0)
+        {
+            size_t parent = (i - 1) / D;
+            if (!(keys_[v] < keys_[heap_[parent]]))
+                break;
+            place (i, heap_[parent]);
+            i = parent;
+        }
+        place (i, v);
+    }
+
+    void siftDown (size_t i)
+    {
+        uint32_t v = heap_[i];
+        size_t n = heap_.size ();
+        while (true)
+        {
+            size_t first = D * i + 1;
+            if (first >= n)
+                break;
+
+            size_t last = first + D < n ? first + D : n;
+            size_t best = first;
+            for (size_t c = first + 1; c < last; c++)
+                if (keys_[heap_[c]] < keys_[heap_[best]])
+                    best = c;
+
+            if (!(keys_[heap_[best]] < keys_[v]))
+                break;
+            place (i, heap_[best]);
+            i = best;
+        }
+        place (i, v);
+    }
+
+public:
+
+    explicit IndexedHeap (size_t count = 0):
+        keys_ (count),
+        pos_ (count, NOT_IN_HEAP)
+    {}
+
+    void resize (size_t count)
+    {
+        clear ();
+        keys_.resize (count);
+        pos_.assign (count, NOT_IN_HEAP);
+    }
+
+    inline bool empty () const { return heap_.empty (); }
+    inline size_t size () const { return heap_.size (); }
+    inline bool contains (size_t v) const { return pos_[v] != NOT_IN_HEAP; }
+
+    // Ключ вершины; осмыслен, пока вершина в куче
+    inline const KeyT &key (size_t v) const { return keys_[v]; }
+
+    inline uint32_t top () const
+    {
+        assert (!empty ());
+        return heap_[0];
+    }
+
+    void push (size_t v, const KeyT &key)
+    {
+        assert (!contains (v));
+        keys_[v] = key;
+        heap_.push_back ((uint32_t) v);
+        siftUp (heap_.size () - 1);
+    }
+
+    void decreaseKey (size_t v, const KeyT &key)
+    {
+        assert (contains (v) && !(keys_[v] < key));
+        keys_[v] = key;
+        siftUp (pos_[v]);
+    }
+
+    // Вставляет v или уменьшает её ключ; возвращает true, если ключ изменился
+    bool pushOrDecrease (size_t v, const KeyT &key)
+    {
+        if (!contains (v))
+        {
+            push (v, key);
+            return true;
+        }
+        if (!(key < keys_[v]))
+            return false;
+        decreaseKey (v, key);
+        return true;
+    }
+
+    uint32_t pop ()
+    {
+        assert (!empty ());
+        uint32_t v = heap_[0];
+        pos_[v] = NOT_IN_HEAP;
+
+        uint32_t last = heap_.back ();
+        heap_.pop_back ();
+        if (!heap_.empty ())
+        {
+            heap_[0] = last;
+            siftDown (0);
+        }
+        return v;
+    }
+
+    void clear ()
+    {
+        for (uint32_t v: heap_)
+            pos_[v] = NOT_IN_HEAP;
+        heap_.clear ();
+    }
+};
+
+#endif // ! __INDEXED_HEAP_HPP__
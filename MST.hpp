@@ -0,0 +1,261 @@
+#ifndef __MST_HPP__
+#define __MST_HPP__
+
+/*
+ * Минимальный остовный лес взвешенного графа: Prim, Kruskal, Boruvka
+ */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "WeightedGraph.hpp"
+#include "IndexedHeap.hpp"
+#include "DisjointSets.hpp"
+
+// Prime algo: O(E log V) на индексированной куче с decrease-key.
+// Для несвязного графа строится минимальный остовный лес (по дереву на компоненту).
+// Graph — WeightedGraph или CSRGraph: нужны size () и getNeibs (u) с парами (v, weight)
+template <typename WeightT, template <typename> class Graph>
+WeightedGraph<WeightT> getMST (const Graph<WeightT>& g)
+{
+    const size_t NONE = (size_t)-1;
+    size_t n = g.size ();
+
+    WeightedGraph<WeightT> mst (n);
+    IndexedHeap <WeightT> heap (n);
+    std::vector <size_t> parent (n, NONE);
+    std::vector <bool> inTree (n, false);
+
+    // Каждая ещё не покрытая вершина начинает новое дерево леса
+    for (size_t root = 0; root < n; ++root)
+    {
+        if (inTree[root])
+            continue;
+
+        heap.push (root, WeightT { });
+
+        while (!heap.empty ())
+        {
+            // Достаём вершину, ближайшую к дереву, и добавляем в MST ребро, по которому она ближе всего
+            size_t u = heap.top ();
+            WeightT weight = heap.key (u);
+            heap.pop ();
+
+            inTree[u] = true;
+            if (parent[u] != NONE)
+                mst.insert (parent[u], u, weight);
+
+            // Обновляем расстояния до дерева у соседей u
+            for (auto [v, newWeight]: g.getNeibs(u))
+            {
+                if (inTree[v])
+                    continue;
+                if (heap.pushOrDecrease (v, newWeight))
+                    parent[v] = u;
+            }
+        }
+    }
+
+    return mst;
+}
+
+// Выполнить func (begin, end) над [0, count), разрезанным на threads кусков
+template <typename Func>
+void parallelFor (size_t count, unsigned threads, Func func)
+{
+    if (threads <= 1 || count < 2 * threads)
+    {
+        func ((size_t) 0, count);
+        return;
+    }
+
+    std::vector <std::thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (unsigned t = 1; t < threads; t++)
+    {
+        size_t begin = std::min (count, t * chunk), end = std::min (count, begin + chunk);
+        workers.emplace_back (func, begin, end);
+    }
+    func ((size_t) 0, std::min (count, chunk));
+
+    for (auto &worker: workers)
+        worker.join ();
+}
+
+// Сортировка кусками в threads потоков с последующими попарными слияниями
+template <typename It, typename Compare>
+void parallelSort (It first, It last, Compare comp, unsigned threads)
+{
+    size_t count = last - first;
+    size_t pieces = 1;
+    while (pieces < threads)
+        pieces *= 2;
+    size_t chunk = (count + pieces - 1) / pieces;
+    if (pieces == 1 || chunk < 4096)
+    {
+        std::sort (first, last, comp);
+        return;
+    }
+
+    auto bound = [&] (size_t i) { return first + std::min (count, i * chunk); };
+
+    parallelFor (pieces, threads, [&] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            std::sort (bound (i), bound (i + 1), comp);
+    });
+
+    for (size_t width = 1; width < pieces; width *= 2)
+    {
+        parallelFor (pieces / (2 * width), threads, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                std::inplace_merge (bound (2 * i * width), bound ((2 * i + 1) * width), bound ((2 * i + 2) * width), comp);
+        });
+    }
+}
+
+// Все рёбра графа по одному разу (u < v)
+template <typename WeightT, template <typename> class Graph>
+std::vector <typename WeightedGraph<WeightT>::WeightedEdge> getEdges (const Graph<WeightT>& g)
+{
+    std::vector <typename WeightedGraph<WeightT>::WeightedEdge> edges;
+    for (size_t u = 0; u < g.size (); ++u)
+        for (auto [v, weight]: g.getNeibs(u))
+            if (v > u) edges.push_back ({u, (size_t) v, weight});
+    return edges;
+}
+
+// Kruskal algo: параллельная сортировка рёбер по весу и жадный проход с DisjointSets. O(E log E)
+template <typename WeightT, template <typename> class Graph>
+WeightedGraph<WeightT> getMSTKruskal (const Graph<WeightT>& g, unsigned threads = std::thread::hardware_concurrency ())
+{
+    auto edges = getEdges (g);
+    parallelSort (edges.begin (), edges.end (),
+                  [] (const auto &lhs, const auto &rhs) { return lhs.weight < rhs.weight; }, threads);
+
+    WeightedGraph<WeightT> mst (g.size ());
+    DisjointSets sets (g.size ());
+    size_t mstEdges = 0;
+
+    for (auto &edge: edges)
+    {
+        if (sets.unite (edge.u, edge.v))
+        {
+            mst.insert (edge);
+            if (++mstEdges + 1 == g.size ())
+                break;
+        }
+    }
+
+    return mst;
+}
+
+// Boruvka algo: за раунд каждая компонента выбирает самое лёгкое исходящее ребро (параллельно по рёбрам),
+// выбранные рёбра сливают компоненты, внутренние рёбра отбрасываются. O(log V) раундов по O(E / threads)
+template <typename WeightT, template <typename> class Graph>
+WeightedGraph<WeightT> getMSTBoruvka (const Graph<WeightT>& g, unsigned threads = std::thread::hardware_concurrency ())
+{
+    const uint64_t NONE = UINT64_MAX;
+    size_t n = g.size ();
+
+    auto edges = getEdges (g);
+    WeightedGraph<WeightT> mst (n);
+    DisjointSets sets (n);
+
+    std::vector <uint32_t> comp (n);
+    for (size_t v = 0; v < n; v++)
+        comp[v] = (uint32_t) v;
+
+    std::vector <std::atomic <uint64_t>> cheapest (n);
+
+    // Строгий порядок (вес, номер ребра): без него при равных весах могут образоваться циклы
+    auto lighter = [&] (uint64_t lhs, uint64_t rhs) {
+        return rhs == NONE
+            || edges[lhs].weight < edges[rhs].weight
+            || (!(edges[rhs].weight < edges[lhs].weight) && lhs < rhs);
+    };
+
+    while (!edges.empty ())
+    {
+        for (auto &best: cheapest)
+            best.store (NONE, std::memory_order_relaxed);
+
+        parallelFor (edges.size (), threads, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                for (uint32_t c: {comp[edges[i].u], comp[edges[i].v]})
+                {
+                    uint64_t current = cheapest[c].load (std::memory_order_relaxed);
+                    while (lighter (i, current) && !cheapest[c].compare_exchange_weak (current, i));
+                }
+            }
+        });
+
+        for (size_t c = 0; c < n; c++)
+        {
+            uint64_t best = cheapest[c].load (std::memory_order_relaxed);
+            if (best != NONE && sets.unite (edges[best].u, edges[best].v))
+                mst.insert (edges[best]);
+        }
+
+        for (size_t v = 0; v < n; v++)
+            comp[v] = (uint32_t) sets.find (v);
+
+        // Отбрасываем рёбра внутри компонент
+        std::vector <std::vector <typename WeightedGraph<WeightT>::WeightedEdge>> kept (threads ? threads : 1);
+        std::atomic <unsigned> nextPart (0);
+        std::vector <std::pair <size_t, size_t>> parts (kept.size ());
+        parallelFor (edges.size (), (unsigned) kept.size (), [&] (size_t begin, size_t end) {
+            unsigned part = nextPart++;
+            parts[part] = {begin, end};
+            for (size_t i = begin; i < end; i++)
+                if (comp[edges[i].u] != comp[edges[i].v])
+                    kept[part].push_back (edges[i]);
+        });
+
+        // склеиваем части в исходном порядке рёбер
+        std::vector <size_t> order (nextPart);
+        for (size_t i = 0; i < order.size (); i++)
+            order[i] = i;
+        std::sort (order.begin (), order.end (), [&] (size_t lhs, size_t rhs) { return parts[lhs].first < parts[rhs].first; });
+
+        edges.clear ();
+        for (size_t part: order)
+            edges.insert (edges.end (), kept[part].begin (), kept[part].end ());
+    }
+
+    return mst;
+}
+
+enum class Strategy
+{
+    PRIM,
+    KRUSKAL,
+    BORUVKA
+};
+
+// Единая точка входа: минимальный остовный лес выбранным алгоритмом
+template <typename WeightT, template <typename> class Graph>
+WeightedGraph<WeightT> mst (const Graph<WeightT>& g, Strategy strategy)
+{
+    switch (strategy)
+    {
+        case Strategy::KRUSKAL: return getMSTKruskal (g);
+        case Strategy::BORUVKA: return getMSTBoruvka (g);
+        case Strategy::PRIM:
+        default:                return getMST (g);
+    }
+}
+
+template <typename WeightT>
+WeightT totalWeight (const WeightedGraph<WeightT> &g)
+{
+    WeightT total { };
+    for (size_t u = 0; u < g.size (); ++u)
+        for (auto [v, weight]: g.getNeibs(u))
+            if (v > u) total += weight;
+    return total;
+}
+
+#endif // ! __MST_HPP__
@@ -0,0 +1,187 @@
+#ifndef __MODULAR_ARITHMETIC_H__
+#define __MODULAR_ARITHMETIC_H__
+
+/*
+ * Модульная арифметика по 64-битному модулю; подключается и из C, и из C++.
+ *
+ * mulMod/powMod — через 128-битное произведение и аппаратное деление, любой модуль.
+ * Montgomery — нечётный модуль < 2^64: числа хранятся как aR mod m, R = 2^64, и
+ *   умножение обходится двумя умножениями без деления.
+ * Barrett — модуль < 2^32: остаток через умножение на заранее посчитанное 2^64 / m.
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * a * b по модулю mod
+ */
+static inline uint64_t mulMod (uint64_t a, uint64_t b, uint64_t mod)
+{
+    return (uint64_t) ((unsigned __int128) a * b % mod);
+}
+
+/*
+ * возвести base в степень power по модулю mod
+ */
+static inline uint64_t powMod (uint64_t base, uint64_t power, uint64_t mod)
+{
+    uint64_t result = 1 % mod;
+    base %= mod;
+    for (; power; power >>= 1)
+    {
+        if (power & 1) result = mulMod (result, base, mod);
+        base = mulMod (base, base, mod);
+    }
+    return result;
+}
+
+/*
+ * a^-1 по простому модулю prime (малая теорема Ферма)
+ */
+static inline uint64_t inverseMod (uint64_t a, uint64_t prime)
+{
+    return powMod (a, prime - 2, prime);
+}
+
+/*
+ * Форма Монтгомери для нечётного mod: inverse = mod^-1 (mod 2^64), one = R mod mod, r2 = R^2 mod mod
+ */
+typedef struct
+{
+    uint64_t mod, inverse, one, r2;
+} Montgomery;
+
+static inline Montgomery montgomeryInit (uint64_t mod)
+{
+    Montgomery m;
+    m.mod = mod;
+    /* Ньютон: верных бит 3 -> 6 -> 12 -> 24 -> 48 -> 96 */
+    m.inverse = mod;
+    for (int i = 0; i < 5; i++)
+        m.inverse *= 2 - mod * m.inverse;
+    m.one = (uint64_t) (-mod) % mod;
+    m.r2 = mulMod (m.one, m.one, mod);
+    return m;
+}
+
+/*
+ * t R^-1 по модулю mod для t < mod * 2^64. Младшие слова t и q * mod совпадают,
+ * поэтому разность старших слов — уже ответ с точностью до одного mod; переполнения нет при любом mod
+ */
+static inline uint64_t montgomeryReduce (const Montgomery *m, unsigned __int128 t)
+{
+    uint64_t q = (uint64_t) t * m->inverse;
+    uint64_t high = (uint64_t) (t >> 64), subtrahend = (uint64_t) (((unsigned __int128) q * m->mod) >> 64);
+    return high >= subtrahend ? high - subtrahend : high - subtrahend + m->mod;
+}
+
+static inline uint64_t montgomeryMul (const Montgomery *m, uint64_t a, uint64_t b)
+{
+    return montgomeryReduce (m, (unsigned __int128) a * b);
+}
+
+static inline uint64_t montgomeryTo (const Montgomery *m, uint64_t a)
+{
+    return montgomeryMul (m, a % m->mod, m->r2);
+}
+
+static inline uint64_t montgomeryFrom (const Montgomery *m, uint64_t a)
+{
+    return montgomeryReduce (m, a);
+}
+
+static inline uint64_t montgomeryAdd (const Montgomery *m, uint64_t a, uint64_t b)
+{
+    return a >= m->mod - b ? a - (m->mod - b) : a + b;
+}
+
+/*
+ * base и результат — в форме Монтгомери
+ */
+static inline uint64_t montgomeryPow (const Montgomery *m, uint64_t base, uint64_t power)
+{
+    uint64_t result = m->one;
+    for (; power; power >>= 1)
+    {
+        if (power & 1) result = montgomeryMul (m, result, base);
+        base = montgomeryMul (m, base, base);
+    }
+    return result;
+}
+
+/*
+ * Обратный в форме Монтгомери по простому модулю: (aR)^(p-2) R^-(p-3) = a^-1 R
+ */
+static inline uint64_t montgomeryInverse (const Montgomery *m, uint64_t a)
+{
+    return montgomeryPow (m, a, m->mod - 2);
+}
+
+/*
+ * Обратить count ненулевых элементов values (форма Монтгомери, модуль простой) на месте
+ * приёмом Монтгомери: префиксные произведения, одно обращение, обратный проход —
+ * 3 (count - 1) умножения вместо count возведений в степень. scratch — count элементов
+ */
+static inline void montgomeryBatchInverse (const Montgomery *m, uint64_t *values, uint64_t *scratch, size_t count)
+{
+    if (count == 0) return;
+
+    scratch[0] = values[0];
+    for (size_t i = 1; i < count; i++)
+        scratch[i] = montgomeryMul (m, scratch[i - 1], values[i]);
+
+    uint64_t inverse = montgomeryInverse (m, scratch[count - 1]);
+    for (size_t i = count - 1; i > 0; i--)
+    {
+        uint64_t value = values[i];
+        values[i] = montgomeryMul (m, inverse, scratch[i - 1]);
+        inverse = montgomeryMul (m, inverse, value);
+    }
+    values[0] = inverse;
+}
+
+/*
+ * Редукция Барретта для mod < 2^32: factor = floor ((2^64 - 1) / mod), частное занижено не больше чем на 2
+ */
+typedef struct
+{
+    uint64_t mod, factor;
+} Barrett;
+
+static inline Barrett barrettInit (uint64_t mod)
+{
+    Barrett b;
+    b.mod = mod;
+    b.factor = UINT64_MAX / mod;
+    return b;
+}
+
+static inline uint64_t barrettReduce (const Barrett *b, uint64_t a)
+{
+    uint64_t q = (uint64_t) (((unsigned __int128) a * b->factor) >> 64);
+    uint64_t r = a - q * b->mod;
+    while (r >= b->mod) r -= b->mod;
+    return r;
+}
+
+/*
+ * a, b < mod < 2^32: произведение помещается в 64 бита
+ */
+static inline uint64_t barrettMul (const Barrett *b, uint64_t x, uint64_t y)
+{
+    return barrettReduce (b, x * y);
+}
+
+static inline uint64_t barrettPow (const Barrett *b, uint64_t base, uint64_t power)
+{
+    uint64_t result = 1 % b->mod;
+    base = barrettReduce (b, base);
+    for (; power; power >>= 1)
+    {
+        if (power & 1) result = barrettMul (b, result, base);
+        base = barrettMul (b, base, base);
+    }
+    return result;
+}
+
+#endif // ! __MODULAR_ARITHMETIC_H__
@@ -0,0 +1,188 @@
+#ifndef __NUMBER_THEORY_HPP__
+#define __NUMBER_THEORY_HPP__
+
+/*
+ * 64-битная теория чисел: проверка простоты (детерминированный Миллер — Рабин),
+ * разложение на множители (Pollard rho в варианте Брента), мультипликативный порядок.
+ * Модули здесь нечётные, поэтому вся арифметика — в форме Монтгомери
+ */
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+
+#include "ModularArithmetic.h"
+
+// Детерминированно для всех n < 2^64
+inline bool isPrime (uint64_t n)
+{
+    const uint64_t SMALL[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (n < 2)
+        return false;
+    for (uint64_t p: SMALL)
+        if (n % p == 0)
+            return n == p;
+
+    uint64_t d = n - 1;
+    int s = 0;
+    for (; d % 2 == 0; d /= 2)
+        s++;
+
+    Montgomery m = montgomeryInit (n);
+    uint64_t minusOne = n - m.one;
+    for (uint64_t base: {2ULL, 325ULL, 9375ULL, 28178ULL, 450775ULL, 9780504ULL, 1795265022ULL})
+    {
+        uint64_t x = montgomeryPow (&m, montgomeryTo (&m, base), d);
+        if (x == 0 || x == m.one || x == minusOne)
+            continue;
+
+        bool composite = true;
+        for (int i = 1; i < s && composite; i++)
+        {
+            x = montgomeryMul (&m, x, x);
+            composite = x != minusOne;
+        }
+        if (composite)
+            return false;
+    }
+    return true;
+}
+
+// Нетривиальный делитель составного нечётного n. Поиск цикла x -> x^2 + c по Бренту;
+// gcd считается не на каждом шаге, а от произведения BATCH разностей. Последовательность
+// идёт прямо в форме Монтгомери: разности отличаются множителем R, взаимно простым с n
+inline uint64_t pollardRho (uint64_t n)
+{
+    const uint64_t BATCH = 128;
+    Montgomery m = montgomeryInit (n);
+
+    for (uint64_t c = 1;; c++)
+    {
+        auto step = [&m, c] (uint64_t x) { return montgomeryAdd (&m, montgomeryMul (&m, x, x), c); };
+
+        uint64_t y = 2, x = y, saved = y, divisor = 1, product = m.one;
+        for (uint64_t power = 1; divisor == 1; power *= 2)
+        {
+            x = y;
+            for (uint64_t i = 0; i < power; i++)
+                y = step (y);
+
+            for (uint64_t done = 0; done < power && divisor == 1; done += BATCH)
+            {
+                saved = y;
+                for (uint64_t i = 0; i < std::min (BATCH, power - done); i++)
+                {
+                    y = step (y);
+                    product = montgomeryMul (&m, product, x > y ? x - y : y - x);
+                }
+                divisor = std::gcd (product, n);
+            }
+        }
+
+        // произведение обнулилось — повторяем последнюю пачку по одному шагу
+        if (divisor == n)
+        {
+            do
+            {
+                saved = step (saved);
+                divisor = std::gcd (x > saved ? x - saved : saved - x, n);
+            } while (divisor == 1);
+        }
+
+        if (divisor != n)
+            return divisor;
+    }
+}
+
+// Разложение n > 0: пары (простое, степень) по возрастанию
+inline std::vector <std::pair <uint64_t, unsigned>> factorize (uint64_t n)
+{
+    std::vector <uint64_t> primes;
+
+    for (uint64_t p = 2; p < 1000 && p * p <= n; p += (p == 2 ? 1 : 2))
+        for (; n % p == 0; n /= p)
+            primes.push_back (p);
+
+    std::vector <uint64_t> stack;
+    if (n > 1)
+        stack.push_back (n);
+    while (!stack.empty ())
+    {
+        uint64_t m = stack.back ();
+        stack.pop_back ();
+        if (isPrime (m))
+        {
+            primes.push_back (m);
+            continue;
+        }
+        uint64_t d = pollardRho (m);
+        stack.push_back (d);
+        stack.push_back (m / d);
+    }
+
+    std::sort (primes.begin (), primes.end ());
+    std::vector <std::pair <uint64_t, unsigned>> result;
+    for (uint64_t p: primes)
+    {
+        if (result.empty () || result.back ().first != p)
+            result.push_back ({p, 0});
+        result.back ().second++;
+    }
+    return result;
+}
+
+// Наименьшее k > 0, что a^k = 1 (mod m); m > 1 нечётно, gcd (a, m) = 1.
+// Порядок делит функцию Кармайкла λ(m) = lcm (p^(k-1) (p - 1)); из λ выкидываются
+// простые множители, пока a^(λ/p) = 1
+inline uint64_t multiplicativeOrder (uint64_t a, uint64_t m)
+{
+    std::vector <std::pair <uint64_t, unsigned>> lambda;
+    auto merge = [&lambda] (uint64_t p, unsigned k)
+    {
+        for (auto &[q, e]: lambda)
+            if (q == p)
+            {
+                e = std::max (e, k);
+                return;
+            }
+        lambda.push_back ({p, k});
+    };
+
+    for (auto [p, k]: factorize (m))
+    {
+        // λ(p^k) = p^(k-1) (p - 1); степени каждого простого — максимум по всем p^k
+        std::vector <std::pair <uint64_t, unsigned>> part = factorize (p - 1);
+        if (k > 1)
+        {
+            bool added = false;
+            for (auto &[q, e]: part)
+                if (q == p)
+                {
+                    e += k - 1;
+                    added = true;
+                }
+            if (!added)
+                part.push_back ({p, k - 1});
+        }
+
+        // lcm по простым: одинаковые степени в разных λ(p^k) не перемножаются
+        for (auto [q, e]: part)
+            merge (q, e);
+    }
+
+    uint64_t order = 1;
+    for (auto [q, e]: lambda)
+        for (unsigned i = 0; i < e; i++)
+            order *= q;
+
+    Montgomery mont = montgomeryInit (m);
+    uint64_t base = montgomeryTo (&mont, a);
+    for (auto [q, e]: lambda)
+        for (unsigned i = 0; i < e && order % q == 0 && montgomeryPow (&mont, base, order / q) == mont.one; i++)
+            order /= q;
+
+    return order;
+}
+
+#endif // ! __NUMBER_THEORY_HPP__
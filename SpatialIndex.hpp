@@ -0,0 +1,379 @@
+#ifndef __SPATIAL_INDEX_HPP__
+#define __SPATIAL_INDEX_HPP__
+
+/*
+ * Пространственные индексы над массивом Point:
+ *   GridHash — равномерная сетка в хеш-таблице; на ней ближайшая пара за ожидаемое O(n)
+ *   (рандомизированный инкрементальный алгоритм в духе Рабина) и все пары в радиусе r;
+ *   KdTree — k-d дерево с пакетными запросами k ближайших и точек в радиусе.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <queue>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <thread>
+#include "ClosestPair.hpp"
+
+// Хеш-таблица непустых клеток сетки со стороной cell: клетка -> односвязный список точек.
+// Совпадение ключей у далёких клеток (переполнение координат) лишь добавляет лишние кандидаты
+class GridHash
+{
+    double cell_;
+    std::vector <uint64_t> keys_;
+    std::vector <int> heads_;      // -1 — пустой слот
+    std::vector <int> next_;       // следующая точка той же клетки, по номеру точки
+    size_t mask_, used_;
+
+    static inline uint64_t pack (int64_t cx, int64_t cy)
+    {
+        return (uint64_t) (uint32_t) cx << 32 | (uint32_t) cy;
+    }
+
+    static inline size_t hash (uint64_t key)
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    inline int64_t cellOf (double c) const
+    {
+        const double LIMIT = 4e18;
+        double scaled = std::floor (c / cell_);
+        return (int64_t) std::clamp (scaled, -LIMIT, LIMIT);
+    }
+
+    size_t slotOf (uint64_t key) const
+    {
+        size_t slot = hash (key) & mask_;
+        while (heads_[slot] != -1 && keys_[slot] != key)
+            slot = (slot + 1) & mask_;
+        return slot;
+    }
+
+    void grow ()
+    {
+        std::vector <uint64_t> keys (std::move (keys_));
+        std::vector <int> heads (std::move (heads_));
+
+        keys_.assign (keys.size () * 2, 0);
+        heads_.assign (heads.size () * 2, -1);
+        mask_ = keys_.size () - 1;
+
+        for (size_t slot = 0; slot < keys.size (); slot++)
+            if (heads[slot] != -1)
+            {
+                size_t to = slotOf (keys[slot]);
+                keys_[to] = keys[slot];
+                heads_[to] = heads[slot];
+            }
+    }
+
+public:
+
+    // points — общее число точек, которые могут быть вставлены (номера 0..points-1)
+    explicit GridHash (size_t points):
+        cell_ (1), next_ (points, -1), mask_ (0), used_ (0)
+    {}
+
+    // Очистить и задать сторону клетки; expected — ожидаемое число точек
+    void reset (double cell, size_t expected)
+    {
+        size_t capacity = 16;
+        while (capacity < 2 * expected)
+            capacity *= 2;
+
+        cell_ = cell;
+        keys_.assign (capacity, 0);
+        heads_.assign (capacity, -1);
+        mask_ = capacity - 1;
+        used_ = 0;
+    }
+
+    void insert (int id, const Point &p)
+    {
+        uint64_t key = pack (cellOf (p.x), cellOf (p.y));
+        size_t slot = slotOf (key);
+        if (heads_[slot] == -1)
+        {
+            keys_[slot] = key;
+            used_++;
+        }
+        next_[id] = heads_[slot];
+        heads_[slot] = id;
+
+        if (2 * used_ > keys_.size ())
+            grow ();
+    }
+
+    // func (j) для всех точек из клеток 3x3 вокруг клетки p: среди них все точки на расстоянии <= cell
+    template <typename Func>
+    void forNeighbours (const Point &p, Func func) const
+    {
+        int64_t cx = cellOf (p.x), cy = cellOf (p.y);
+        for (int64_t dx = -1; dx <= 1; dx++)
+        for (int64_t dy = -1; dy <= 1; dy++)
+        {
+            size_t slot = slotOf (pack (cx + dx, cy + dy));
+            for (int j = heads_[slot]; j != -1; j = next_[j])
+                func (j);
+        }
+    }
+};
+
+// Ближайшая пара за ожидаемое O(n): точки добавляются в случайном порядке в сетку со стороной,
+// равной текущему минимуму; при его уменьшении сетка перестраивается (с вероятностью O(1/i) на шаге i).
+// Затем один проход по сетке со стороной найденного минимума выбирает пару по тем же правилам
+// ничьих, что и findClosestPair. n >= 2
+inline ClosestPair findClosestPairGrid (const Point *points, int n, uint64_t seed = 1)
+{
+    std::vector <int> order (n);
+    std::iota (order.begin (), order.end (), 0);
+    std::shuffle (order.begin (), order.end (), std::mt19937_64 (seed));
+
+    GridHash grid (n);
+    double bestSqr = calcDistanceSqr (points[order[0]], points[order[1]]);
+
+    auto rebuild = [&] (int count)
+    {
+        grid.reset (std::sqrt (bestSqr), count);
+        for (int k = 0; k < count; k++)
+            grid.insert (order[k], points[order[k]]);
+    };
+
+    if (bestSqr > 0)
+        rebuild (2);
+
+    for (int i = 2; i < n && bestSqr > 0; i++)
+    {
+        const Point &p = points[order[i]];
+        double nearestSqr = INFINITY;
+        grid.forNeighbours (p, [&] (int j) { nearestSqr = std::min (nearestSqr, calcDistanceSqr (p, points[j])); });
+
+        if (nearestSqr < bestSqr)
+        {
+            bestSqr = nearestSqr;
+            if (bestSqr > 0)
+                rebuild (i + 1);
+        }
+        else
+            grid.insert (order[i], p);
+    }
+
+    // все пары, равные минимуму с точностью isZero
+    ClosestPair best;
+    grid.reset (std::sqrt (bestSqr + EPS), n);
+    for (int i = 0; i < n; i++)
+    {
+        grid.forNeighbours (points[i], [&] (int j)
+        {
+            double distSqr = calcDistanceSqr (points[i], points[j]);
+            if (notFarther (distSqr, bestSqr))
+                best.update (i, j, distSqr);
+        });
+        grid.insert (i, points[i]);
+    }
+
+    return best;
+}
+
+// Все пары (i < j) на расстоянии не больше r, по возрастанию. O(n + ответ) для ограниченной плотности
+inline std::vector <std::pair <int, int>> pairsWithinRadius (const Point *points, int n, double r)
+{
+    std::vector <std::pair <int, int>> result;
+    double rSqr = r * r;
+
+    GridHash grid (n);
+    grid.reset (std::max (r, std::sqrt (EPS)), n);
+    for (int i = 0; i < n; i++)
+    {
+        grid.forNeighbours (points[i], [&] (int j)
+        {
+            if (calcDistanceSqr (points[i], points[j]) <= rSqr)
+                result.push_back ({j, i});
+        });
+        grid.insert (i, points[i]);
+    }
+
+    std::sort (result.begin (), result.end ());
+    return result;
+}
+
+class KdTree
+{
+    static const int LEAF_SIZE = 8;
+
+    // Поддерево — отрезок [lo, hi); медиана узла лежит в mid = (lo + hi) / 2,
+    // левое поддерево — [lo, mid), правое — [mid + 1, hi)
+    std::vector <IndexedPoint> points_;
+    std::vector <unsigned char> axis_;
+
+    static inline double coord (const Point &p, int axis)
+    {
+        return axis ? p.y : p.x;
+    }
+
+    void build (int lo, int hi)
+    {
+        if (hi - lo <= LEAF_SIZE)
+            return;
+
+        double minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY;
+        for (int i = lo; i < hi; i++)
+        {
+            minX = std::min (minX, points_[i].x); maxX = std::max (maxX, points_[i].x);
+            minY = std::min (minY, points_[i].y); maxY = std::max (maxY, points_[i].y);
+        }
+
+        int axis = maxY - minY > maxX - minX;
+        int mid = (lo + hi) / 2;
+        std::nth_element (points_.begin () + lo, points_.begin () + mid, points_.begin () + hi,
+                          [axis] (const IndexedPoint &lhs, const IndexedPoint &rhs) { return coord (lhs, axis) < coord (rhs, axis); });
+        axis_[mid] = axis;
+
+        build (lo, mid);
+        build (mid + 1, hi);
+    }
+
+    // Кандидаты упорядочены по (расстояние, номер): ответ однозначен при равных расстояниях
+    using Candidate = std::pair <double, int>;
+    using Heap = std::priority_queue <Candidate>;
+
+    static inline void offer (Heap &heap, size_t k, const Candidate &candidate)
+    {
+        if (heap.size () < k)
+            heap.push (candidate);
+        else if (candidate < heap.top ())
+        {
+            heap.pop ();
+            heap.push (candidate);
+        }
+    }
+
+    void nearest (const Point &q, int lo, int hi, size_t k, Heap &heap) const
+    {
+        if (hi - lo <= LEAF_SIZE)
+        {
+            for (int i = lo; i < hi; i++)
+                offer (heap, k, {calcDistanceSqr (q, points_[i]), points_[i].index});
+            return;
+        }
+
+        int mid = (lo + hi) / 2;
+        int axis = axis_[mid];
+        offer (heap, k, {calcDistanceSqr (q, points_[mid]), points_[mid].index});
+
+        double delta = coord (q, axis) - coord (points_[mid], axis);
+        bool leftFirst = delta < 0;
+
+        if (leftFirst) nearest (q, lo, mid, k, heap);
+        else           nearest (q, mid + 1, hi, k, heap);
+
+        if (heap.size () < k || delta * delta <= heap.top ().first)
+        {
+            if (leftFirst) nearest (q, mid + 1, hi, k, heap);
+            else           nearest (q, lo, mid, k, heap);
+        }
+    }
+
+    void withinRadius (const Point &q, double rSqr, int lo, int hi, std::vector <int> &result) const
+    {
+        if (hi - lo <= LEAF_SIZE)
+        {
+            for (int i = lo; i < hi; i++)
+                if (calcDistanceSqr (q, points_[i]) <= rSqr)
+                    result.push_back (points_[i].index);
+            return;
+        }
+
+        int mid = (lo + hi) / 2;
+        int axis = axis_[mid];
+        if (calcDistanceSqr (q, points_[mid]) <= rSqr)
+            result.push_back (points_[mid].index);
+
+        double delta = coord (q, axis) - coord (points_[mid], axis);
+        if (delta <= 0 || delta * delta <= rSqr)
+            withinRadius (q, rSqr, lo, mid, result);
+        if (delta >= 0 || delta * delta <= rSqr)
+            withinRadius (q, rSqr, mid + 1, hi, result);
+    }
+
+    // func (i) для i из [0, count), разбитых на threads непрерывных кусков
+    template <typename Func>
+    static void forEachQuery (int count, unsigned threads, Func func)
+    {
+        threads = std::max (1u, std::min (threads, (unsigned) std::max (count, 1)));
+        std::vector <std::thread> workers;
+        for (unsigned t = 1; t < threads; t++)
+            workers.emplace_back ([&, t] {
+                for (int i = (int) ((int64_t) count * t / threads); i < (int) ((int64_t) count * (t + 1) / threads); i++)
+                    func (i);
+            });
+        for (int i = 0; i < (int) ((int64_t) count / threads); i++)
+            func (i);
+        for (auto &worker: workers)
+            worker.join ();
+    }
+
+public:
+
+    KdTree (const Point *points, int n):
+        points_ (n), axis_ (n, 0)
+    {
+        for (int i = 0; i < n; i++)
+            points_[i] = {points[i], i};
+        build (0, n);
+    }
+
+    inline int size () const { return (int) points_.size (); }
+
+    // Номера k ближайших к q точек по возрастанию расстояния (при равенстве — по номеру)
+    std::vector <int> nearest (const Point &q, int k) const
+    {
+        Heap heap;
+        if (k > 0)
+            nearest (q, 0, size (), k, heap);
+
+        std::vector <int> result (heap.size ());
+        for (size_t i = heap.size (); i-- > 0; heap.pop ())
+            result[i] = heap.top ().second;
+        return result;
+    }
+
+    // Номера точек на расстоянии не больше r от q, по возрастанию
+    std::vector <int> withinRadius (const Point &q, double r) const
+    {
+        std::vector <int> result;
+        withinRadius (q, r * r, 0, size (), result);
+        std::sort (result.begin (), result.end ());
+        return result;
+    }
+
+    // k ближайших для каждого запроса: строка i — result[i * k, (i + 1) * k), недостающие — -1
+    std::vector <int> nearestBatch (const Point *queries, int count, int k,
+                                    unsigned threads = std::thread::hardware_concurrency ()) const
+    {
+        std::vector <int> result ((size_t) count * k, -1);
+        forEachQuery (count, threads, [&] (int i)
+        {
+            std::vector <int> row = nearest (queries[i], k);
+            std::copy (row.begin (), row.end (), result.begin () + (size_t) i * k);
+        });
+        return result;
+    }
+
+    std::vector <std::vector <int>> withinRadiusBatch (const Point *queries, int count, double r,
+                                                       unsigned threads = std::thread::hardware_concurrency ()) const
+    {
+        std::vector <std::vector <int>> result (count);
+        forEachQuery (count, threads, [&] (int i) { result[i] = withinRadius (queries[i], r); });
+        return result;
+    }
+};
+
+#endif // ! __SPATIAL_INDEX_HPP__
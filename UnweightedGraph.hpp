@@ -0,0 +1,899 @@
+#ifndef __UNWEIGHTED_GRAPH_HPP__
+#define __UNWEIGHTED_GRAPH_HPP__
+
+/*
+ * Ориентированный невзвешенный граф на векторе смежности с политикой хранения соседей
+ * и алгоритмы над ним: BFS (последовательный и параллельный), DFS, SCC, topo sort
+ */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <set>
+#include <stack>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*
+ * Политики хранения списка соседей. Каждая поддерживает insert/erase/contains (insert и erase
+ * возвращают false, если ничего не изменилось), size и обход через begin/end.
+ */
+
+// Красно-чёрное дерево: соседи упорядочены, каждый — отдельный узел в куче
+using SetAdjacency = std::set <int>;
+
+// Отсортированный массив с N соседями внутри самого объекта: без аллокаций для вершин малой степени,
+// обход — линейный проход по памяти. insert/erase O(степень), contains O(log степени)
+template <unsigned N = 6>
+class SmallSortedVector
+{
+    int inline_[N];
+    int *data_;
+    uint32_t size_, capacity_;
+
+    void grow ()
+    {
+        capacity_ *= 2;
+        int *data = new int [capacity_];
+        std::copy (data_, data_ + size_, data);
+        if (data_ != inline_)
+            delete[] data_;
+        data_ = data;
+    }
+
+public:
+
+    SmallSortedVector ():
+        data_ (inline_),
+        size_ (0),
+        capacity_ (N)
+    {}
+
+    SmallSortedVector (const SmallSortedVector &other):
+        SmallSortedVector ()
+    {
+        *this = other;
+    }
+
+    SmallSortedVector (SmallSortedVector &&other):
+        SmallSortedVector ()
+    {
+        *this = std::move (other);
+    }
+
+    SmallSortedVector &operator= (const SmallSortedVector &other)
+    {
+        if (this == &other)
+            return *this;
+        size_ = 0;
+        while (capacity_ < other.size_)
+            grow ();
+        std::copy (other.begin (), other.end (), data_);
+        size_ = other.size_;
+        return *this;
+    }
+
+    SmallSortedVector &operator= (SmallSortedVector &&other)
+    {
+        if (this == &other)
+            return *this;
+        if (other.data_ == other.inline_)
+            return *this = (const SmallSortedVector &) other;
+
+        if (data_ != inline_)
+            delete[] data_;
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+
+        other.data_ = other.inline_;
+        other.size_ = 0;
+        other.capacity_ = N;
+        return *this;
+    }
+
+    ~SmallSortedVector ()
+    {
+        if (data_ != inline_)
+            delete[] data_;
+    }
+
+    bool insert (int v)
+    {
+        int *it = std::lower_bound (data_, data_ + size_, v);
+        if (it != data_ + size_ && *it == v)
+            return false;
+
+        size_t pos = it - data_;
+        if (size_ == capacity_)
+            grow ();
+        std::copy_backward (data_ + pos, data_ + size_, data_ + size_ + 1);
+        data_[pos] = v;
+        size_++;
+        return true;
+    }
+
+    bool erase (int v)
+    {
+        int *it = std::lower_bound (data_, data_ + size_, v);
+        if (it == data_ + size_ || *it != v)
+            return false;
+
+        std::copy (it + 1, data_ + size_, it);
+        size_--;
+        return true;
+    }
+
+    bool contains (int v) const
+    {
+        return std::binary_search (data_, data_ + size_, v);
+    }
+
+    inline const int *begin () const { return data_; }
+    inline const int *end () const { return data_ + size_; }
+    inline size_t size () const { return size_; }
+    inline bool empty () const { return size_ == 0; }
+};
+
+// Хеш-множество с открытой адресацией и линейным пробированием: contains/insert/erase за O(1) в среднем
+// на вершинах большой степени. Порядок обхода соседей не определён
+class FlatHashSet
+{
+    static constexpr int EMPTY = -1, DELETED = -2;
+
+    std::vector <int> slots_;
+    uint32_t size_, used_;
+
+    size_t slotOf (int v) const
+    {
+        return ((uint32_t) v * 2654435769u) & (slots_.size () - 1);
+    }
+
+    void rehash (size_t capacity)
+    {
+        std::vector <int> old (capacity, EMPTY);
+        old.swap (slots_);
+        size_ = used_ = 0;
+        for (int v: old)
+            if (v >= 0)
+                insert (v);
+    }
+
+public:
+
+    class Iterator
+    {
+        const int *slot_, *end_;
+
+        void skip ()
+        {
+            while (slot_ != end_ && *slot_ < 0)
+                ++slot_;
+        }
+
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int *;
+        using reference = int;
+
+        Iterator (const int *slot, const int *end):
+            slot_ (slot),
+            end_ (end)
+        {
+            skip ();
+        }
+
+        int operator* () const { return *slot_; }
+        Iterator &operator++ () { ++slot_; skip (); return *this; }
+        bool operator!= (const Iterator &other) const { return slot_ != other.slot_; }
+        bool operator== (const Iterator &other) const { return slot_ == other.slot_; }
+    };
+
+    FlatHashSet ():
+        size_ (0),
+        used_ (0)
+    {}
+
+    bool insert (int v)
+    {
+        if (2 * (used_ + 1) > slots_.size ())
+            rehash (std::max <size_t> (8, 4 * (size_ + 1) > slots_.size () ? 2 * slots_.size () : slots_.size ()));
+
+        size_t mask = slots_.size () - 1;
+        size_t firstDeleted = SIZE_MAX;
+        for (size_t i = slotOf (v);; i = (i + 1) & mask)
+        {
+            if (slots_[i] == v)
+                return false;
+            if (slots_[i] == DELETED && firstDeleted == SIZE_MAX)
+                firstDeleted = i;
+            if (slots_[i] == EMPTY)
+            {
+                if (firstDeleted != SIZE_MAX)
+                    i = firstDeleted;
+                else
+                    used_++;
+                slots_[i] = v;
+                size_++;
+                return true;
+            }
+        }
+    }
+
+    bool erase (int v)
+    {
+        if (slots_.empty ())
+            return false;
+
+        size_t mask = slots_.size () - 1;
+        for (size_t i = slotOf (v); slots_[i] != EMPTY; i = (i + 1) & mask)
+        {
+            if (slots_[i] == v)
+            {
+                slots_[i] = DELETED;
+                size_--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains (int v) const
+    {
+        if (slots_.empty ())
+            return false;
+
+        size_t mask = slots_.size () - 1;
+        for (size_t i = slotOf (v); slots_[i] != EMPTY; i = (i + 1) & mask)
+            if (slots_[i] == v)
+                return true;
+        return false;
+    }
+
+    inline Iterator begin () const { return {slots_.data (), slots_.data () + slots_.size ()}; }
+    inline Iterator end () const { return {slots_.data () + slots_.size (), slots_.data () + slots_.size ()}; }
+    inline size_t size () const { return size_; }
+    inline bool empty () const { return size_ == 0; }
+};
+
+template <typename Adjacency = SetAdjacency>
+class BasicUnweightedGraph
+{
+    std::vector <Adjacency> neibs;
+
+public:
+
+    explicit BasicUnweightedGraph (size_t count):
+        neibs (count) 
+    {}
+
+    bool insert (size_t u, size_t v)
+    {
+        if (neibs[u].contains(v))
+            return false;
+
+        neibs[u].insert (v);
+        return true;
+    }
+
+    bool erase (size_t u, size_t v)
+    {
+        if (!neibs[u].contains(v))
+            return false;
+
+        neibs[u].erase (v);
+        return true;
+    }
+
+    bool contains (size_t u, size_t v) const
+    {
+        return neibs[u].contains(v);
+    }
+
+    inline size_t size () const
+    {
+        return neibs.size ();
+    }
+
+    inline const Adjacency &getNeibs (size_t u) const
+    {
+        return neibs[u];
+    }
+
+};
+
+using UnweightedGraph = BasicUnweightedGraph <>;
+
+
+template <typename Func, typename Graph>
+void bfs (const Graph &g, int s, Func &func)
+{
+    enum State { UNVISITED, VISITED };
+
+    std::vector <State> state (g.size(), UNVISITED);
+    std::queue <int> queue;
+
+    state[s] = VISITED;
+    queue.push (s);
+
+    while (!queue.empty ())
+    {
+        int u = queue.front (); queue.pop ();
+
+        for (auto v: g.getNeibs(u))
+        {
+            if (state[v] == VISITED)
+                continue;
+
+            func (v, u);
+
+            state [v] = VISITED;
+            queue.push (v);
+        }
+
+        state [u] = VISITED;
+    }
+
+}
+
+/*
+ * Пул потоков для fork-join по уровням: run (job) вызывает job (i) для каждого i из [0, size ())
+ * одновременно (job (0) — в вызывающем потоке) и возвращается, когда все закончили.
+ */
+class ThreadPool
+{
+    std::vector <std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function <void (unsigned)> *job_;
+    uint64_t generation_;
+    unsigned pending_;
+    bool stop_;
+
+    void work (unsigned index)
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            const std::function <void (unsigned)> *job;
+            {
+                std::unique_lock <std::mutex> lock (mutex_);
+                wake_.wait (lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_)
+                    return;
+                seen = generation_;
+                job = job_;
+            }
+
+            (*job) (index);
+
+            std::lock_guard <std::mutex> lock (mutex_);
+            if (--pending_ == 0)
+                done_.notify_one ();
+        }
+    }
+
+public:
+
+    explicit ThreadPool (unsigned threads = std::thread::hardware_concurrency ()):
+        job_ (nullptr),
+        generation_ (0),
+        pending_ (0),
+        stop_ (false)
+    {
+        for (unsigned i = 1; i < threads; i++)
+            workers_.emplace_back (&ThreadPool::work, this, i);
+    }
+
+    ~ThreadPool ()
+    {
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all ();
+        for (auto &worker: workers_)
+            worker.join ();
+    }
+
+    inline unsigned size () const
+    {
+        return workers_.size () + 1;
+    }
+
+    void run (const std::function <void (unsigned)> &job)
+    {
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            job_ = &job;
+            pending_ = workers_.size ();
+            generation_++;
+        }
+        wake_.notify_all ();
+
+        job (0);
+
+        std::unique_lock <std::mutex> lock (mutex_);
+        done_.wait (lock, [&] { return pending_ == 0; });
+    }
+};
+
+/*
+ * Параллельный BFS с переключением направления (Beamer, Asanović, Patterson, "Direction-Optimizing BFS").
+ * Пока фронт мал, уровень обходится сверху вниз: потоки разбирают фронт-очередь и помечают соседей
+ * атомарным fetch_or в битовой карте посещённых. Когда рёбер у фронта становится больше, чем
+ * непросмотренных рёбер / ALPHA, переходим снизу вверх: каждая непосещённая вершина ищет родителя
+ * среди входящих соседей в битовой карте фронта и останавливается на первом. Назад — когда фронт
+ * меньше n / BETA вершин.
+ *
+ * Граф один раз упаковывается в CSR (прямые и обратные рёбра), так что один ParallelBfs
+ * обслуживает сколько угодно запусков.
+ *
+ * func (v, parent) вызывается ровно один раз для каждой достижимой вершины v != s, но из разных
+ * потоков и в произвольном порядке внутри уровня, поэтому func должен допускать одновременные вызовы
+ * для разных v (писать можно только в данные, относящиеся к v). Все вызовы уровня d завершаются до
+ * первого вызова уровня d + 1, так что читать данные родителя (как в GetMinDistance) безопасно.
+ */
+template <typename Graph>
+class ParallelBfs
+{
+    static constexpr size_t ALPHA = 14, BETA = 24;
+    static constexpr size_t CHUNK = 256;
+
+    ThreadPool &pool_;
+    size_t n_;
+    std::vector <uint64_t> outOffsets_, inOffsets_;
+    std::vector <uint32_t> out_, in_;
+
+    inline size_t outDegree (size_t u) const { return outOffsets_[u + 1] - outOffsets_[u]; }
+
+public:
+
+    ParallelBfs (const Graph &g, ThreadPool &pool):
+        pool_ (pool),
+        n_ (g.size ()),
+        outOffsets_ (n_ + 1, 0),
+        inOffsets_ (n_ + 1, 0)
+    {
+        for (size_t u = 0; u < n_; u++)
+        {
+            outOffsets_[u + 1] = outOffsets_[u] + g.getNeibs(u).size ();
+            for (auto v: g.getNeibs(u))
+                inOffsets_[v + 1]++;
+        }
+        for (size_t v = 0; v < n_; v++)
+            inOffsets_[v + 1] += inOffsets_[v];
+
+        out_.resize (outOffsets_[n_]);
+        in_.resize (inOffsets_[n_]);
+        std::vector <uint64_t> inPos (inOffsets_.begin (), inOffsets_.end () - 1);
+        for (size_t u = 0; u < n_; u++)
+        {
+            uint64_t pos = outOffsets_[u];
+            for (auto v: g.getNeibs(u))
+            {
+                out_[pos++] = v;
+                in_[inPos[v]++] = u;
+            }
+        }
+    }
+
+    template <typename Func>
+    void run (int s, Func &func)
+    {
+        size_t words = (n_ + 63) / 64;
+        std::vector <std::atomic <uint64_t>> visited (words);
+        std::vector <uint64_t> frontierBits (words), nextBits (words);
+        std::vector <uint32_t> frontier {(uint32_t) s};
+        std::vector <std::vector <uint32_t>> nextLocal (pool_.size ());
+
+        for (auto &word: visited)
+            word.store (0, std::memory_order_relaxed);
+        visited[s / 64].fetch_or (1ull << (s % 64), std::memory_order_relaxed);
+
+        size_t frontierCount = 1, frontierEdges = outDegree (s);
+        size_t edgesToCheck = out_.size ();
+        bool bottomUp = false;
+
+        while (frontierCount > 0)
+        {
+            if (!bottomUp && frontierEdges > edgesToCheck / ALPHA)
+            {
+                std::fill (frontierBits.begin (), frontierBits.end (), 0);
+                for (uint32_t u: frontier)
+                    frontierBits[u / 64] |= 1ull << (u % 64);
+                bottomUp = true;
+            }
+            else if (bottomUp && frontierCount < n_ / BETA)
+            {
+                frontier.clear ();
+                for (size_t w = 0; w < words; w++)
+                    for (uint64_t bits = frontierBits[w]; bits; bits &= bits - 1)
+                        frontier.push_back (w * 64 + __builtin_ctzll (bits));
+                bottomUp = false;
+            }
+
+            edgesToCheck -= std::min (edgesToCheck, frontierEdges);
+            std::atomic <size_t> cursor (0), nextCount (0), nextEdges (0);
+
+            if (!bottomUp)
+            {
+                pool_.run ([&] (unsigned thread) {
+                    std::vector <uint32_t> &next = nextLocal[thread];
+                    next.clear ();
+                    size_t edges = 0;
+
+                    for (size_t begin; (begin = cursor.fetch_add (CHUNK)) < frontier.size ();)
+                    {
+                        size_t end = std::min (frontier.size (), begin + CHUNK);
+                        for (size_t i = begin; i < end; i++)
+                        {
+                            uint32_t u = frontier[i];
+                            for (uint64_t e = outOffsets_[u]; e < outOffsets_[u + 1]; e++)
+                            {
+                                uint32_t v = out_[e];
+                                uint64_t bit = 1ull << (v % 64);
+                                if (visited[v / 64].load (std::memory_order_relaxed) & bit)
+                                    continue;
+                                if (visited[v / 64].fetch_or (bit, std::memory_order_relaxed) & bit)
+                                    continue;
+
+                                func (v, u);
+                                next.push_back (v);
+                                edges += outDegree (v);
+                            }
+                        }
+                    }
+                    nextEdges += edges;
+                });
+
+                frontier.clear ();
+                for (auto &next: nextLocal)
+                    frontier.insert (frontier.end (), next.begin (), next.end ());
+                frontierCount = frontier.size ();
+            }
+            else
+            {
+                std::fill (nextBits.begin (), nextBits.end (), 0);
+
+                // поток владеет целыми словами битовых карт, так что nextBits пишется без атомиков
+                pool_.run ([&] (unsigned) {
+                    size_t count = 0, edges = 0;
+                    const size_t WORDS_PER_CHUNK = CHUNK / 64;
+
+                    for (size_t begin; (begin = cursor.fetch_add (WORDS_PER_CHUNK)) < words;)
+                    {
+                        size_t end = std::min (words, begin + WORDS_PER_CHUNK);
+                        for (size_t w = begin; w < end; w++)
+                        {
+                            uint64_t unvisited = ~visited[w].load (std::memory_order_relaxed);
+                            if (w == words - 1 && n_ % 64)
+                                unvisited &= (1ull << (n_ % 64)) - 1;
+
+                            for (; unvisited; unvisited &= unvisited - 1)
+                            {
+                                uint32_t v = w * 64 + __builtin_ctzll (unvisited);
+                                for (uint64_t e = inOffsets_[v]; e < inOffsets_[v + 1]; e++)
+                                {
+                                    uint32_t u = in_[e];
+                                    if (!(frontierBits[u / 64] & (1ull << (u % 64))))
+                                        continue;
+
+                                    visited[w].fetch_or (1ull << (v % 64), std::memory_order_relaxed);
+                                    nextBits[w] |= 1ull << (v % 64);
+                                    func (v, u);
+                                    count++;
+                                    edges += outDegree (v);
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                    nextCount += count;
+                    nextEdges += edges;
+                });
+
+                frontierBits.swap (nextBits);
+                frontierCount = nextCount;
+            }
+
+            frontierEdges = nextEdges;
+        }
+    }
+};
+
+template <typename Func, typename Graph>
+void parallelBfs (const Graph &g, int s, Func &func, ThreadPool &pool)
+{
+    ParallelBfs <Graph> (g, pool).run (s, func);
+}
+
+// funcEnter returns 1 if no further search required and vertex is to be closed immediately,
+// returns 0 if further search is required
+template <typename FuncEnter, typename FuncExit, typename Graph>
+void dfs (const Graph &g, size_t s, FuncEnter &funcEnter, FuncExit &funcExit)
+{
+    enum State { UNVISITED, VISITED };
+    const size_t MARK = (size_t)-1;
+
+    std::stack <size_t> stk;
+    std::vector <State> state (g.size(), UNVISITED);
+
+    stk.push (MARK);
+    stk.push (s);
+
+    while (!stk.empty())
+    {
+        size_t u = stk.top (); stk.pop ();
+        state[u] = VISITED;
+
+        if (stk.empty () || stk.top () != MARK)
+        {
+            funcExit (u);
+            continue;
+        }
+
+        stk.pop ();
+        stk.push (u);
+
+        if (funcEnter (u))
+            continue;
+            
+        for (auto v: g.getNeibs(u))
+        {
+            if (state[v] == UNVISITED)
+            {
+                stk.push (MARK);
+                stk.push (v);
+            }
+        }
+    }
+}
+
+/*
+ * Сильно связные компоненты: итеративный Tarjan (явный стек кадров вместо рекурсии, так что
+ * глубина графа ограничена только памятью). Компоненты нумеруются в порядке завершения,
+ * т.е. в обратном топологическом порядке графа компонент. acyclic — нет компонент из
+ * нескольких вершин и нет петель.
+ */
+struct StronglyConnectedComponents
+{
+    std::vector <size_t> component;
+    size_t count;
+    bool acyclic;
+};
+
+template <typename Graph>
+StronglyConnectedComponents tarjanSCC (const Graph &g)
+{
+    const size_t NONE = (size_t)-1;
+    using NeibIterator = decltype (g.getNeibs(0).begin ());
+
+    struct Frame
+    {
+        size_t u;
+        NeibIterator next;
+    };
+
+    size_t n = g.size ();
+    StronglyConnectedComponents result { std::vector <size_t> (n, NONE), 0, true };
+
+    std::vector <size_t> index (n, NONE), low (n);
+    std::vector <bool> onStack (n, false);
+    std::vector <size_t> stack;
+    std::vector <Frame> frames;
+    size_t time = 0;
+
+    auto enter = [&] (size_t u) {
+        index[u] = low[u] = time++;
+        stack.push_back (u);
+        onStack[u] = true;
+        frames.push_back ({u, g.getNeibs(u).begin ()});
+    };
+
+    for (size_t root = 0; root < n; ++root)
+    {
+        if (index[root] != NONE)
+            continue;
+
+        enter (root);
+        while (!frames.empty ())
+        {
+            Frame &frame = frames.back ();
+            size_t u = frame.u;
+
+            if (frame.next != g.getNeibs(u).end ())
+            {
+                size_t v = *frame.next;
+                ++frame.next;
+
+                if (v == u)
+                    result.acyclic = false;
+                if (index[v] == NONE)
+                    enter (v);
+                else if (onStack[v])
+                    low[u] = std::min (low[u], index[v]);
+                continue;
+            }
+
+            // все соседи u просмотрены: u — корень компоненты, если до меньших индексов не дотянулись
+            frames.pop_back ();
+            if (!frames.empty ())
+                low[frames.back ().u] = std::min (low[frames.back ().u], low[u]);
+
+            if (low[u] != index[u])
+                continue;
+
+            size_t size = 0, v;
+            do
+            {
+                v = stack.back ();
+                stack.pop_back ();
+                onStack[v] = false;
+                result.component[v] = result.count;
+                size++;
+            } while (v != u);
+
+            if (size > 1)
+                result.acyclic = false;
+            result.count++;
+        }
+    }
+
+    return result;
+}
+
+// Какой-нибудь цикл графа (вершины по порядку обхода, последняя ведёт в первую); пусто, если граф ацикличен
+template <typename Graph>
+std::vector <size_t> findCycle (const Graph &g)
+{
+    const size_t NONE = (size_t)-1;
+    StronglyConnectedComponents scc = tarjanSCC (g);
+    if (scc.acyclic)
+        return {};
+
+    // вершина из компоненты с циклом: петля или компонента хотя бы из двух вершин
+    std::vector <size_t> sizes (scc.count, 0);
+    for (size_t c: scc.component)
+        sizes[c]++;
+
+    size_t start = NONE;
+    for (size_t u = 0; u < g.size () && start == NONE; ++u)
+        if (sizes[scc.component[u]] > 1 || g.contains (u, u))
+            start = u;
+
+    if (g.contains (start, start))
+        return {start};
+
+    // BFS внутри компоненты от start до ребра, возвращающегося в start
+    std::vector <size_t> parent (g.size (), NONE);
+    std::queue <size_t> queue;
+    queue.push (start);
+    parent[start] = start;
+
+    while (!queue.empty ())
+    {
+        size_t u = queue.front (); queue.pop ();
+        for (size_t v: g.getNeibs(u))
+        {
+            if (scc.component[v] != scc.component[start])
+                continue;
+
+            if (v == start)
+            {
+                std::vector <size_t> cycle;
+                for (size_t x = u; x != start; x = parent[x])
+                    cycle.push_back (x);
+                cycle.push_back (start);
+                std::reverse (cycle.begin (), cycle.end ());
+                return cycle;
+            }
+
+            if (parent[v] == NONE)
+            {
+                parent[v] = u;
+                queue.push (v);
+            }
+        }
+    }
+
+    return {};
+}
+
+// topo sort of DAG g: answer[u] — момент выхода из u при DFS, u идёт раньше v, если answer[u] > answer[v].
+// На графе с циклом возвращает пустой вектор (цикл можно получить через findCycle)
+template <typename Graph>
+std::vector <size_t> topoSort (const Graph &g)
+{
+    StronglyConnectedComponents scc = tarjanSCC (g);
+    if (!scc.acyclic)
+        return {};
+
+    // в DAG каждая компонента — одна вершина, и её номер — как раз время выхода
+    return scc.component;
+}
+
+/*
+ * Топологическая сортировка по уровням (Kahn): уровень 0 — вершины без входящих рёбер,
+ * уровень d + 1 — вершины, все предшественники которых лежат на уровнях <= d. Вершины одного уровня
+ * независимы и могут выполняться параллельно. Уровень k — order[levelStart[k] .. levelStart[k + 1]).
+ * Если pool задан, каждый уровень разбирается его потоками (счётчики входящих рёбер атомарные).
+ * acyclic == false, если часть вершин так и не освободилась — они в order не попадают.
+ */
+struct TopoLevels
+{
+    std::vector <size_t> order;
+    std::vector <size_t> levelStart;
+    bool acyclic;
+
+    inline size_t levels () const
+    {
+        return levelStart.size () - 1;
+    }
+};
+
+template <typename Graph>
+TopoLevels topoLevels (const Graph &g, ThreadPool *pool = nullptr)
+{
+    const size_t CHUNK = 1024;
+    size_t n = g.size ();
+
+    std::vector <std::atomic <uint32_t>> indegree (n);
+    for (auto &count: indegree)
+        count.store (0, std::memory_order_relaxed);
+    for (size_t u = 0; u < n; ++u)
+        for (size_t v: g.getNeibs(u))
+            indegree[v].fetch_add (1, std::memory_order_relaxed);
+
+    TopoLevels result { {}, {0}, true };
+    result.order.reserve (n);
+    for (size_t u = 0; u < n; ++u)
+        if (indegree[u].load (std::memory_order_relaxed) == 0)
+            result.order.push_back (u);
+
+    unsigned threads = pool ? pool->size () : 1;
+    std::vector <std::vector <size_t>> nextLocal (threads);
+
+    for (size_t begin = 0; begin < result.order.size ();)
+    {
+        size_t end = result.order.size ();
+        result.levelStart.push_back (end);
+
+        std::atomic <size_t> cursor (begin);
+        auto releaseLevel = [&] (unsigned thread) {
+            std::vector <size_t> &next = nextLocal[thread];
+            next.clear ();
+            for (size_t from; (from = cursor.fetch_add (CHUNK)) < end;)
+            {
+                for (size_t i = from; i < std::min (end, from + CHUNK); i++)
+                    for (size_t v: g.getNeibs(result.order[i]))
+                        if (indegree[v].fetch_sub (1, std::memory_order_acq_rel) == 1)
+                            next.push_back (v);
+            }
+        };
+
+        bool parallel = pool && end - begin > CHUNK;
+        if (parallel)
+            pool->run (releaseLevel);
+        else
+            releaseLevel (0);
+
+        for (unsigned t = 0; t < (parallel ? threads : 1); t++)
+            result.order.insert (result.order.end (), nextLocal[t].begin (), nextLocal[t].end ());
+
+        begin = end;
+    }
+
+    result.acyclic = result.order.size () == n;
+    return result;
+}
+
+#endif // ! __UNWEIGHTED_GRAPH_HPP__
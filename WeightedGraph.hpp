@@ -1,6 +1,7 @@
 #ifndef __WEIGHTED_GRAPH_HPP__
 #define __WEIGHTED_GRAPH_HPP__
 
+#include <cstddef>
 #include <vector>
 #include <map>
 #include <queue>
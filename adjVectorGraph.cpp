@@ -2,183 +2,12 @@
  * Граф, представленный вектором смежности, с реализованными алгоритмами DFS, BFS, topo sort
  */
 #include <vector>
-#include <queue>
-#include <set>
-#include <stack>
 #include <cstdio>
-
-class UnweightedGraph
-{
-    std::vector <std::set <int>> neibs;
-
-public:
-
-    explicit UnweightedGraph (size_t count):
-        neibs (count) 
-    {}
-
-    bool insert (size_t u, size_t v)
-    {
-        if (neibs[u].contains(v))
-            return false;
-
-        neibs[u].insert (v);
-        return true;
-    }
-
-    bool erase (size_t u, size_t v)
-    {
-        if (!neibs[u].contains(v))
-            return false;
-
-        neibs[u].erase (v);
-        return true;
-    }
-
-    bool contains (size_t u, size_t v) const
-    {
-        return neibs[u].contains(v);
-    }
-
-    inline size_t size () const
-    {
-        return neibs.size ();
-    }
-
-    inline const std::set <int> &getNeibs (size_t u) const
-    {
-        return neibs[u];
-    }
-
-};
-
-
-template <typename Func>
-void bfs (const UnweightedGraph &g, int s, Func &func)
-{
-    enum State { UNVISITED, VISITED };
-
-    std::vector <State> state (g.size(), UNVISITED);
-    std::queue <int> queue;
-
-    state[s] = VISITED;
-    queue.push (s);
-
-    while (!queue.empty ())
-    {
-        int u = queue.front (); queue.pop ();
-
-        for (auto v: g.getNeibs(u))
-        {
-            if (state[v] == VISITED)
-                continue;
-
-            func (v, u);
-
-            state [v] = VISITED;
-            queue.push (v);
-        }
-
-        state [u] = VISITED;
-    }
-
-}
-
-// funcEnter returns 1 if no further search required and vertex is to be closed immediately,
-// returns 0 if further search is required
-template <typename FuncEnter, typename FuncExit>
-void dfs (const UnweightedGraph &g, size_t s, FuncEnter &funcEnter, FuncExit &funcExit)
-{
-    enum State { UNVISITED, VISITED };
-    const size_t MARK = (size_t)-1;
-
-    std::stack <size_t> stk;
-    std::vector <State> state (g.size(), UNVISITED);
-
-    stk.push (MARK);
-    stk.push (s);
-
-    while (!stk.empty())
-    {
-        size_t u = stk.top (); stk.pop ();
-        state[u] = VISITED;
-
-        if (stk.empty () || stk.top () != MARK)
-        {
-            funcExit (u);
-            continue;
-        }
-
-        stk.pop ();
-        stk.push (u);
-
-        if (funcEnter (u))
-            continue;
-            
-        for (auto v: g.getNeibs(u))
-        {
-            if (state[v] == UNVISITED)
-            {
-                stk.push (MARK);
-                stk.push (v);
-            }
-        }
-    }
-}
-
-// topo sort of DAG g (if not acyclic, gigo)
-std::vector <size_t> topoSort (const UnweightedGraph &g)
-{
-    struct OnEntry
-    {
-        enum Color { BLACK, WHITE };
-        std::vector <Color> color;
-
-        OnEntry (size_t n):
-            color (n, WHITE)
-        {}
-
-        bool operator () (size_t u)
-        {
-            printf ("%lu entered\n", u);
-            if (color [u] == BLACK) return true;
-            color [u] = WHITE;
-            return false;
-        }
-
-    };
-
-    struct OnExit
-    {
-        enum Color { BLACK, WHITE };
-        std::vector <size_t> answer;
-        size_t time;
-
-        OnExit (size_t n):
-            answer (n, (size_t)-1),
-            time (0)
-        {}
-
-        bool operator () (size_t u)
-        {
-            if (answer [u] != (size_t)-1) return true;
-            answer [u] = time++;
-            return false;
-        }
-    };
-
-    size_t n = g.size ();
-    OnEntry onEntry (n);
-    OnExit onExit (n);
-
-    for (size_t vertex = 0; vertex < n; ++vertex)
-    {
-        if (onExit.answer [vertex] == (size_t)-1)
-            dfs (g, vertex, onEntry, onExit);
-    }
-
-    return onExit.answer;
-}
+#include <cstring>
+#include <chrono>
+#include "UnweightedGraph.hpp"
+#include "GraphGenerators.hpp"
+#include "GraphSnapshot.hpp"
 
 void bfsDemo ()
 {
@@ -284,10 +113,159 @@ void topoSortDemo ()
     for (auto ord: sorted)
         printf ("%lu\n", ord);
 
+    TopoLevels levels = topoLevels (g);
+    for (size_t level = 0; level < levels.levels (); level++)
+    {
+        printf ("level %lu:", level);
+        for (size_t i = levels.levelStart[level]; i < levels.levelStart[level + 1]; i++)
+            printf (" %lu", levels.order[i]);
+        printf ("\n");
+    }
+
+    g.insert (4, 1);
+    printf ("after adding 4 -> 1, cycle:");
+    for (auto u: findCycle (g))
+        printf (" %lu", u);
+    printf ("\n");
 }
 
-int main ()
+template <typename Graph>
+void benchmarkAdjacency (const char *name, const std::vector <WeightedGraph<int>::WeightedEdge> &edges, size_t n)
 {
-    topoSortDemo ();
+    struct CountVisits
+    {
+        size_t count = 0;
+        void operator () (int, int) { count++; }
+    };
+    struct Enter
+    {
+        size_t count = 0;
+        bool operator () (size_t) { count++; return false; }
+    };
+    struct Exit
+    {
+        void operator () (size_t) {}
+    };
+
+    auto start = std::chrono::steady_clock::now ();
+    Graph g (n);
+    for (auto &edge: edges)
+    {
+        g.insert (edge.u, edge.v);
+        g.insert (edge.v, edge.u);
+    }
+    auto built = std::chrono::steady_clock::now ();
+
+    CountVisits visits;
+    bfs (g, 0, visits);
+    auto bfsDone = std::chrono::steady_clock::now ();
+
+    Enter enter;
+    Exit exit;
+    dfs (g, 0, enter, exit);
+    auto dfsDone = std::chrono::steady_clock::now ();
+
+    auto ms = [] (auto from, auto to) { return std::chrono::duration <double, std::milli> (to - from).count (); };
+    printf ("%-12s build %8.1f ms  bfs %8.1f ms  dfs %8.1f ms  (visited %zu / %zu)\n",
+            name, ms (start, built), ms (built, bfsDone), ms (bfsDone, dfsDone), visits.count + 1, enter.count);
+}
+
+void benchmarkAdjacencies ()
+{
+    const size_t N = 300000, DEGREE = 8;
+    auto edges = powerLawEdges (N, DEGREE, 1);
+    printf ("power-law graph: V=%zu E=%zu\n", N, edges.size ());
+
+    benchmarkAdjacency <BasicUnweightedGraph <SetAdjacency>> ("set", edges, N);
+    benchmarkAdjacency <BasicUnweightedGraph <SmallSortedVector <>>> ("small-vector", edges, N);
+    benchmarkAdjacency <BasicUnweightedGraph <FlatHashSet>> ("flat-hash", edges, N);
+
+    // Последовательный BFS против параллельного с переключением направления на одном графе
+    struct GetMinDistance
+    {
+        std::vector <int> distances;
+
+        GetMinDistance (size_t n, size_t vertexFrom):
+            distances (n, -1)
+        {
+            distances[vertexFrom] = 0;
+        }
+
+        void operator () (int vertex, int parent)
+        {
+            distances [vertex] = distances [parent] + 1;
+        }
+    };
+
+    BasicUnweightedGraph <SmallSortedVector <>> g (N);
+    for (auto &edge: edges)
+    {
+        g.insert (edge.u, edge.v);
+        g.insert (edge.v, edge.u);
+    }
+
+    ThreadPool pool;
+    ParallelBfs <decltype (g)> parallel (g, pool);
+
+    GetMinDistance serialDistances (N, 0), parallelDistances (N, 0);
+    auto start = std::chrono::steady_clock::now ();
+    bfs (g, 0, serialDistances);
+    auto serialDone = std::chrono::steady_clock::now ();
+    parallel.run (0, parallelDistances);
+    auto parallelDone = std::chrono::steady_clock::now ();
+
+    auto ms = [] (auto from, auto to) { return std::chrono::duration <double, std::milli> (to - from).count (); };
+    printf ("bfs serial %.1f ms, direction-optimizing (%u threads) %.1f ms, distances %s\n",
+            ms (start, serialDone), pool.size (), ms (serialDone, parallelDone),
+            serialDistances.distances == parallelDistances.distances ? "match" : "DIFFER");
 }
 
+int main (int argc, char **argv)
+{
+    if (argc > 1 && strcmp (argv[1], "bench") == 0)
+    {
+        benchmarkAdjacencies ();
+        return 0;
+    }
+
+    // import edges.txt graph.bin: текстовый список дуг "u v" -> бинарный снимок
+    if (argc > 3 && strcmp (argv[1], "import") == 0)
+    {
+        EdgeList<int> list = importEdgeList<int> (argv[2]);
+        if (!list.ok)
+        {
+            fprintf (stderr, "cannot parse %s\n", argv[2]);
+            return 1;
+        }
+
+        BasicUnweightedGraph <SmallSortedVector <>> g (list.vertices);
+        for (auto &edge: list.edges)
+            g.insert (edge.u, edge.v);
+        if (!writeSnapshot (argv[3], g))
+        {
+            fprintf (stderr, "cannot write %s\n", argv[3]);
+            return 1;
+        }
+        return 0;
+    }
+
+    // load graph.bin: уровни топологической сортировки графа, отображённого из снимка
+    if (argc > 2 && strcmp (argv[1], "load") == 0)
+    {
+        MappedGraph<> g;
+        if (!g.open (argv[2], true))
+        {
+            fprintf (stderr, "%s: %s\n", argv[2], g.error ());
+            return 1;
+        }
+
+        TopoLevels levels = topoLevels (g);
+        if (levels.acyclic)
+            printf ("%zu vertices, %zu edges, %zu levels\n", g.size (), g.edgeCount (), levels.levels ());
+        else
+            printf ("%zu vertices, %zu edges, cyclic\n", g.size (), g.edgeCount ());
+        return 0;
+    }
+
+    topoSortDemo ();
+}
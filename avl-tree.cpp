@@ -26,6 +26,19 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <queue>
+#include <random>
+#include <chrono>
+#include <concepts>
+#include <cstring>
 
 template <typename T>
 struct AVLTree
@@ -116,12 +129,16 @@ struct AVLTree
             int balanceFactor = getBalanceFactor ();
             if (balanceFactor <= -2) // assert == -2
             {
-                if (right_ && right_->getBalanceFactor () < 0)
-                    rotateRight (&right_); 
-                return rotateRight (thisref); // если баланс правого отрицателен, так вращать нельзя
+                if (left_->getBalanceFactor () > 0)
+                    rotateLeft (&left_); 
+                return rotateRight (thisref); // если баланс левого положителен, так вращать нельзя
             }
             else if (balanceFactor >= 2) // assert == 2
+            {
+                if (right_->getBalanceFactor () < 0)
+                    rotateRight (&right_);
                 return rotateLeft (thisref);
+            }
         }
         
         void insert (const T& value, AVLNode **thisref)
@@ -171,6 +188,179 @@ struct AVLTree
             }
         }
 
+        static int heightOf (const AVLNode *node)
+        {
+            return node == nullptr ? 0 : node->height_;
+        }
+
+        static int sizeOf (const AVLNode *node)
+        {
+            return node == nullptr ? 0 : 1 + node->count_.left_ + node->count_.right_;
+        }
+
+        // Подвешивает к node поддеревья left и right, пересчитывая счётчики и высоту
+        static AVLNode *attach (AVLNode *node, AVLNode *left, AVLNode *right)
+        {
+            node->left_ = left;
+            node->right_ = right;
+            node->count_ = {sizeOf (left), sizeOf (right)};
+            node->fix ();
+            return node;
+        }
+
+        // Строит идеально сбалансированное дерево из отсортированного [first, last) за O(n)
+        static AVLNode *build (const T *first, const T *last)
+        {
+            if (first == last)
+                return nullptr;
+
+            const T *mid = first + (last - first) / 2;
+            return attach (new AVLNode (*mid), build (first, mid), build (mid + 1, last));
+        }
+
+        static void destroy (AVLNode *node)
+        {
+            if (node == nullptr)
+                return;
+            destroy (node->left_);
+            destroy (node->right_);
+            delete node;
+        }
+
+        /*
+         * Операции, основанные на join (Blelloch et al., "Just Join for Parallel Ordered Sets").
+         * Инвариант: ключи левого поддерева <= data_ <= ключи правого (дубликаты допустимы с обеих сторон).
+         */
+
+        // Склеивает tl, node, tr при условии tl <= node->data_ <= tr за O(|h(tl) - h(tr)| + 1)
+        static AVLNode *join (AVLNode *tl, AVLNode *node, AVLNode *tr)
+        {
+            if (heightOf (tl) > heightOf (tr) + 1)
+                return joinRight (tl, node, tr);
+            if (heightOf (tr) > heightOf (tl) + 1)
+                return joinLeft (tl, node, tr);
+            return attach (node, tl, tr);
+        }
+
+        // tl выше tr: спускаемся по правому краю tl до поддерева высоты h(tr) или h(tr) + 1
+        static AVLNode *joinRight (AVLNode *tl, AVLNode *node, AVLNode *tr)
+        {
+            AVLNode *l = tl->left_, *c = tl->right_;
+
+            if (heightOf (c) <= heightOf (tr) + 1)
+            {
+                AVLNode *t = attach (node, c, tr);
+                if (heightOf (t) <= heightOf (l) + 1)
+                    return attach (tl, l, t);
+
+                rotateRight (&t);
+                attach (tl, l, t);
+                rotateLeft (&tl);
+                return tl;
+            }
+
+            AVLNode *t = joinRight (c, node, tr);
+            attach (tl, l, t);
+            if (heightOf (t) > heightOf (l) + 1)
+                rotateLeft (&tl);
+            return tl;
+        }
+
+        static AVLNode *joinLeft (AVLNode *tl, AVLNode *node, AVLNode *tr)
+        {
+            AVLNode *c = tr->left_, *r = tr->right_;
+
+            if (heightOf (c) <= heightOf (tl) + 1)
+            {
+                AVLNode *t = attach (node, tl, c);
+                if (heightOf (t) <= heightOf (r) + 1)
+                    return attach (tr, t, r);
+
+                rotateLeft (&t);
+                attach (tr, t, r);
+                rotateRight (&tr);
+                return tr;
+            }
+
+            AVLNode *t = joinLeft (tl, node, c);
+            attach (tr, t, r);
+            if (heightOf (t) > heightOf (r) + 1)
+                rotateRight (&tr);
+            return tr;
+        }
+
+        // Склеивает tl и tr (tl <= tr) без разделяющего узла
+        static AVLNode *join (AVLNode *tl, AVLNode *tr)
+        {
+            if (tl == nullptr)
+                return tr;
+
+            AVLNode *last = nullptr;
+            tl = splitLast (tl, &last);
+            return join (tl, last, tr);
+        }
+
+        // Отрезает от дерева максимальный узел, возвращает остаток
+        static AVLNode *splitLast (AVLNode *node, AVLNode **last)
+        {
+            if (node->right_ == nullptr)
+            {
+                *last = node;
+                return node->left_;
+            }
+
+            AVLNode *l = node->left_;
+            AVLNode *r = splitLast (node->right_, last);
+            return join (l, node, r);
+        }
+
+        // Разрезает дерево на ключи < key и ключи >= key за O(log n)
+        static std::pair <AVLNode *, AVLNode *> split (AVLNode *node, const T& key)
+        {
+            if (node == nullptr)
+                return {nullptr, nullptr};
+
+            AVLNode *l = node->left_, *r = node->right_;
+            if (!(node->data_ < key))
+            {
+                auto [ll, lr] = split (l, key);
+                return {ll, join (lr, node, r)};
+            }
+
+            auto [rl, rr] = split (r, key);
+            return {join (l, node, rl), rr};
+        }
+
+        // Объединение мультимножеств. Первые forkDepth уровней рекурсии выполняются параллельно
+        static AVLNode *unite (AVLNode *a, AVLNode *b, int forkDepth)
+        {
+            const int SERIAL_CUTOFF = 1 << 14;
+
+            if (a == nullptr) return b;
+            if (b == nullptr) return a;
+
+            if (sizeOf (a) + sizeOf (b) < SERIAL_CUTOFF)
+                forkDepth = 0;
+
+            auto [bl, br] = split (b, a->data_);
+            AVLNode *al = a->left_, *ar = a->right_;
+            AVLNode *l = nullptr, *r = nullptr;
+
+            if (forkDepth > 0)
+            {
+                std::thread worker ([&] { l = unite (al, bl, forkDepth - 1); });
+                r = unite (ar, br, forkDepth - 1);
+                worker.join ();
+            }
+            else
+            {
+                l = unite (al, bl, 0);
+                r = unite (ar, br, 0);
+            }
+
+            return join (l, a, r);
+        }
+
         void dump (FILE* out, int depth) const
         {
             if (right_) right_->dump (out, depth + 1);
@@ -186,38 +376,658 @@ struct AVLTree
 
 public:
 
+    AVLTree ():
+        root_ (nullptr)
+    {}
+
     AVLTree (const T& value): 
         root_ (new AVLNode (value)) 
     {}
 
-    ~AVLTree () 
+    AVLTree (const AVLTree&) = delete;
+    AVLTree& operator= (const AVLTree&) = delete;
+
+    AVLTree (AVLTree&& other):
+        root_ (std::exchange (other.root_, nullptr))
     {}
 
+    AVLTree& operator= (AVLTree&& other)
+    {
+        std::swap (root_, other.root_);
+        return *this;
+    }
+
+    ~AVLTree () 
+    {
+        AVLNode::destroy (root_);
+    }
+
+    // Построение из отсортированного по неубыванию массива за O(n) без поворотов
+    static AVLTree fromSorted (const T *first, const T *last)
+    {
+        AVLTree tree;
+        tree.root_ = AVLNode::build (first, last);
+        return tree;
+    }
 
     inline void insert (const T& value)
     {
-        root_->insert (value, &root_);
+        if (root_ == nullptr)
+            root_ = new AVLNode (value);
+        else
+            root_->insert (value, &root_);
     }
 
     inline const T& findMedian () const
     {
+        assert (root_);
         return root_->findMedian (0, 0);
     }
 
+    inline int size () const
+    {
+        return AVLNode::sizeOf (root_);
+    }
+
+    // k-й по возрастанию элемент (нумерация с нуля)
+    const T& kth (int k) const
+    {
+        assert (0 <= k && k < size ());
+        const AVLNode *node = root_;
+        while (k != node->count_.left_)
+        {
+            if (k < node->count_.left_)
+                node = node->left_;
+            else
+            {
+                k -= node->count_.left_ + 1;
+                node = node->right_;
+            }
+        }
+        return node->data_;
+    }
+
+    // Количество элементов < key (orEqual: <= key)
+    int countLess (const T& key, bool orEqual = false) const
+    {
+        int count = 0;
+        for (const AVLNode *node = root_; node != nullptr;)
+        {
+            if (node->data_ < key || (orEqual && !(key < node->data_)))
+            {
+                count += node->count_.left_ + 1;
+                node = node->right_;
+            }
+            else
+                node = node->left_;
+        }
+        return count;
+    }
+
+    inline bool empty () const
+    {
+        return root_ == nullptr;
+    }
+
+    inline size_t bytes () const
+    {
+        return size () * sizeof (AVLNode);
+    }
+
+    // Оставляет в дереве ключи < key, возвращает дерево из ключей >= key
+    AVLTree split (const T& key)
+    {
+        auto [less, greaterEqual] = AVLNode::split (root_, key);
+        root_ = less;
+
+        AVLTree rest;
+        rest.root_ = greaterEqual;
+        return rest;
+    }
+
+    // Склейка деревьев, все ключи lhs <= всех ключей rhs. O(log n)
+    static AVLTree join (AVLTree&& lhs, AVLTree&& rhs)
+    {
+        AVLTree tree;
+        tree.root_ = AVLNode::join (std::exchange (lhs.root_, nullptr), std::exchange (rhs.root_, nullptr));
+        return tree;
+    }
+
+    // Слияние произвольных деревьев (например, построенных разными потоками) за O(m log (n/m + 1));
+    // верхние уровни рекурсии распределяются по threads потокам
+    static AVLTree unite (AVLTree&& lhs, AVLTree&& rhs, unsigned threads = std::thread::hardware_concurrency ())
+    {
+        int forkDepth = 0;
+        while ((2u << forkDepth) <= threads)
+            forkDepth++;
+
+        AVLTree tree;
+        tree.root_ = AVLNode::unite (std::exchange (lhs.root_, nullptr), std::exchange (rhs.root_, nullptr), forkDepth);
+        return tree;
+    }
+
     void dump (FILE *out) const
     {
-        root_->dump (out, 0);
+        if (root_)
+            root_->dump (out, 0);
     }
 
-    enum Requests
+};
+
+/*
+ * Конкурентный сервис квантилей поверх AVLTree.
+ *
+ * Данные разбиты на шарды (AVLTree под своим мьютексом). Каждый поток-производитель
+ * получает Producer со своим буфером на BUFFER_SIZE элементов: push не берёт блокировок,
+ * пока буфер не заполнится, после чего буфер сортируется, строится fromSorted
+ * и сливается с шардом через unite — одна блокировка на BUFFER_SIZE вставок.
+ * Запросы берут блокировки всех шардов по порядку и ищут k-й элемент объединения
+ * бинарным поиском по рангам.
+ *
+ * Граница устаревания: запрос, начавшийся после того, как производитель вернулся из push,
+ * видит все его элементы, кроме, возможно, последних (BUFFER_SIZE - 1) ещё не сброшенных.
+ * Суммарно запрос не видит не более producers * (BUFFER_SIZE - 1) завершённых push.
+ * После flush() (или разрушения Producer) все элементы производителя видны.
+ */
+template <typename T>
+class ConcurrentMedian
+{
+    struct Shard
+    {
+        std::mutex mutex;
+        AVLTree <T> tree;
+    };
+
+    std::vector <std::unique_ptr <Shard>> shards_;
+    std::atomic <unsigned> nextShard_;
+    const size_t bufferSize_;
+
+    void spill (Shard &shard, std::vector <T> &buffer)
+    {
+        if (buffer.empty ())
+            return;
+
+        std::sort (buffer.begin (), buffer.end ());
+        AVLTree <T> batch = AVLTree <T>::fromSorted (buffer.data (), buffer.data () + buffer.size ());
+        buffer.clear ();
+
+        std::lock_guard <std::mutex> lock (shard.mutex);
+        shard.tree = AVLTree <T>::unite (std::move (shard.tree), std::move (batch), 1);
+    }
+
+    // Наименьший x среди всех элементов, для которого #{<= x} > k
+    const T& select (int k) const
+    {
+        const T *answer = nullptr;
+        for (auto &candidateShard: shards_)
+        {
+            const AVLTree <T> &tree = candidateShard->tree;
+            int lo = 0, hi = tree.size ();
+            while (lo < hi)
+            {
+                int mid = lo + (hi - lo) / 2;
+                const T& x = tree.kth (mid);
+
+                int lessEqual = 0;
+                for (auto &shard: shards_)
+                    lessEqual += shard->tree.countLess (x, true);
+
+                if (lessEqual > k)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+
+            if (lo < tree.size () && (answer == nullptr || tree.kth (lo) < *answer))
+                answer = &tree.kth (lo);
+        }
+
+        assert (answer);
+        return *answer;
+    }
+
+public:
+
+    static const size_t BUFFER_SIZE = 4096;
+
+    class Producer
     {
-        ADD = 0,
-        FIND_MEDIAN = 1
+        ConcurrentMedian *service_;
+        Shard *shard_;
+        std::vector <T> buffer_;
+
+    public:
+
+        Producer (ConcurrentMedian *service, Shard *shard):
+            service_ (service),
+            shard_ (shard)
+        {
+            buffer_.reserve (service_->bufferSize_);
+        }
+
+        Producer (const Producer&) = delete;
+        Producer (Producer&&) = default;
+
+        ~Producer ()
+        {
+            if (service_)
+                flush ();
+        }
+
+        void push (const T& value)
+        {
+            buffer_.push_back (value);
+            if (buffer_.size () >= service_->bufferSize_)
+                service_->spill (*shard_, buffer_);
+        }
+
+        void flush ()
+        {
+            service_->spill (*shard_, buffer_);
+        }
     };
 
+    explicit ConcurrentMedian (unsigned shards = std::thread::hardware_concurrency (), size_t bufferSize = BUFFER_SIZE):
+        nextShard_ (0),
+        bufferSize_ (bufferSize)
+    {
+        if (shards == 0) shards = 1;
+        for (unsigned i = 0; i < shards; i++)
+            shards_.push_back (std::make_unique <Shard> ());
+    }
+
+    // Производители распределяются по шардам по кругу; один Producer — один поток
+    Producer makeProducer ()
+    {
+        return Producer (this, shards_[nextShard_++ % shards_.size ()].get ());
+    }
+
+    // Число видимых запросам элементов
+    int size () const
+    {
+        int count = 0;
+        for (auto &shard: shards_)
+        {
+            std::lock_guard <std::mutex> lock (shard->mutex);
+            count += shard->tree.size ();
+        }
+        return count;
+    }
+
+    // Квантиль по ближайшему рангу: элемент с номером ceil (q * N) (с единицы), q из (0, 1]
+    T quantile (double q) const
+    {
+        for (auto &shard: shards_)
+            shard->mutex.lock ();
+
+        int count = 0;
+        for (auto &shard: shards_)
+            count += shard->tree.size ();
+        assert (count > 0);
+
+        int k = (int) std::ceil (q * count) - 1;
+        k = std::clamp (k, 0, count - 1);
+        T result = select (k);
+
+        for (auto &shard: shards_)
+            shard->mutex.unlock ();
+        return result;
+    }
+
+    // Медиана в смысле задачи: элемент с номером (N+1)/2
+    T findMedian () const
+    {
+        for (auto &shard: shards_)
+            shard->mutex.lock ();
+
+        int count = 0;
+        for (auto &shard: shards_)
+            count += shard->tree.size ();
+        assert (count > 0);
+
+        T result = select ((count + 1) / 2 - 1);
+
+        for (auto &shard: shards_)
+            shard->mutex.unlock ();
+        return result;
+    }
+};
+
+// Проверка границы устаревания и корректности медианы под нагрузкой: читатель сверяет
+// size () с числом завершённых push, в конце — размер и медиана. false — граница нарушена
+// или итог не сошёлся
+bool concurrentMedianDemo ()
+{
+    const unsigned PRODUCERS = 4;
+    const int PER_PRODUCER = 1000000;
+    const size_t BUFFER = 1024;
+
+    ConcurrentMedian <int> service (PRODUCERS, BUFFER);
+    std::atomic <int> pushed [PRODUCERS] = {};
+    std::atomic <bool> done (false);
+    long long checks = 0, violations = 0;
+
+    std::vector <std::thread> producers;
+    for (unsigned p = 0; p < PRODUCERS; p++)
+        producers.emplace_back ([&, p] {
+            auto producer = service.makeProducer ();
+            for (int i = 0; i < PER_PRODUCER; i++)
+            {
+                producer.push ((int) (p + PRODUCERS * i));
+                pushed[p].store (i + 1, std::memory_order_release);
+            }
+        });
+
+    std::thread reader ([&] {
+        while (!done)
+        {
+            int completed = 0;
+            for (auto &count: pushed)
+                completed += count.load (std::memory_order_acquire);
+
+            int visible = service.size ();
+            checks++;
+            if (visible < completed - (int) (PRODUCERS * (BUFFER - 1)))
+            {
+                if (violations++ == 0)
+                    fprintf (stderr, "staleness bound violated: %d visible, %d completed\n", visible, completed);
+            }
+        }
+    });
+
+    for (auto &thread: producers)
+        thread.join ();
+    done = true;
+    reader.join ();
+
+    // значения 0..N-1 по разу, медиана — (N+1)/2-е
+    const int N = PRODUCERS * PER_PRODUCER;
+    int size = service.size (), median = service.findMedian (), expected = (N + 1) / 2 - 1;
+    printf ("%lld staleness checks, %lld violations; size %d (expected %d), median %d (expected %d), p90 %d\n",
+            checks, violations, size, N, median, expected, service.quantile (0.9));
+
+    return violations == 0 && size == N && median == expected;
+}
+
+/*
+ * Интерфейс движка медианы: вставка и медиана в смысле задачи (элемент с номером (N+1)/2).
+ * bytes () — оценка занимаемой памяти для сравнения движков.
+ */
+template <typename E, typename T>
+concept MedianEngine = requires (E engine, const E cengine, const T& value)
+{
+    engine.insert (value);
+    { cengine.findMedian () } -> std::convertible_to <T>;
+    { cengine.size () } -> std::convertible_to <size_t>;
+    { cengine.bytes () } -> std::convertible_to <size_t>;
+};
+
+static_assert (MedianEngine <AVLTree <int>, int>);
+
+/*
+ * Точная медиана на двух кучах: lower_ — max-куча меньшей половины, upper_ — min-куча большей.
+ * |lower_| == |upper_| или |upper_| + 1, медиана — вершина lower_. Вставка O(log n), запрос O(1).
+ */
+template <typename T>
+class TwoHeapMedian
+{
+    std::priority_queue <T, std::vector <T>, std::less <T>> lower_;
+    std::priority_queue <T, std::vector <T>, std::greater <T>> upper_;
+
+public:
 
+    void insert (const T& value)
+    {
+        if (lower_.empty () || !(lower_.top () < value))
+            lower_.push (value);
+        else
+            upper_.push (value);
+
+        if (lower_.size () > upper_.size () + 1)
+        {
+            upper_.push (lower_.top ());
+            lower_.pop ();
+        }
+        else if (upper_.size () > lower_.size ())
+        {
+            lower_.push (upper_.top ());
+            upper_.pop ();
+        }
+    }
+
+    const T& findMedian () const
+    {
+        assert (!lower_.empty ());
+        return lower_.top ();
+    }
+
+    size_t size () const
+    {
+        return lower_.size () + upper_.size ();
+    }
+
+    size_t bytes () const
+    {
+        return size () * sizeof (T);
+    }
 };
 
+static_assert (MedianEngine <TwoHeapMedian <int>, int>);
+
+/*
+ * Приближённый скетч квантилей KLL (Karnin, Lang, Liberty). Уровень h хранит элементы веса 2^h,
+ * ёмкость уровня ~ k * (2/3)^(H - h). Переполненный уровень сортируется, и каждый второй
+ * элемент (со случайным сдвигом) переходит на уровень выше. Память O(k), ошибка ранга ~ 1/k.
+ * Скетчи сливаются через merge.
+ */
+template <typename T>
+class KLLSketch
+{
+    std::vector <std::vector <T>> levels_;
+    size_t k_;
+    size_t count_;
+    std::minstd_rand random_;
+
+    // отсортированные (значение, вес) — кэш для повторных запросов без вставок
+    mutable std::vector <std::pair <T, uint64_t>> sorted_;
+    mutable bool sortedValid_;
+
+    size_t capacity (size_t level) const
+    {
+        size_t depth = levels_.size () - level - 1;
+        return std::max <size_t> (2, (size_t) (k_ * std::pow (2.0 / 3.0, depth)) + 1);
+    }
+
+    void compress ()
+    {
+        for (size_t h = 0; h < levels_.size (); h++)
+        {
+            if (levels_[h].size () < capacity (h))
+                continue;
+
+            if (h + 1 == levels_.size ())
+                levels_.emplace_back ();
+
+            std::vector <T> &level = levels_[h];
+            std::sort (level.begin (), level.end ());
+
+            size_t offset = random_ () & 1;
+            for (size_t i = offset; i < level.size (); i += 2)
+                levels_[h + 1].push_back (level[i]);
+
+            // нечётный элемент без пары остаётся на уровне
+            if (level.size () % 2 == 1)
+            {
+                T last = level.back ();
+                level.clear ();
+                level.push_back (last);
+                if (offset == 0)
+                    levels_[h + 1].pop_back ();
+            }
+            else
+                level.clear ();
+        }
+    }
+
+public:
+
+    explicit KLLSketch (size_t k = 200, unsigned seed = 1):
+        levels_ (1),
+        k_ (k),
+        count_ (0),
+        random_ (seed),
+        sortedValid_ (false)
+    {}
+
+    void insert (const T& value)
+    {
+        levels_[0].push_back (value);
+        count_++;
+        sortedValid_ = false;
+        if (levels_[0].size () >= capacity (0))
+            compress ();
+    }
+
+    void merge (const KLLSketch &other)
+    {
+        while (levels_.size () < other.levels_.size ())
+            levels_.emplace_back ();
+        for (size_t h = 0; h < other.levels_.size (); h++)
+            levels_[h].insert (levels_[h].end (), other.levels_[h].begin (), other.levels_[h].end ());
+        count_ += other.count_;
+        sortedValid_ = false;
+        compress ();
+    }
+
+    // Приближённый элемент с номером rank (с единицы)
+    T findRank (uint64_t rank) const
+    {
+        if (!sortedValid_)
+        {
+            sorted_.clear ();
+            for (size_t h = 0; h < levels_.size (); h++)
+                for (auto &value: levels_[h])
+                    sorted_.push_back ({value, (uint64_t) 1 << h});
+            std::sort (sorted_.begin (), sorted_.end (),
+                       [] (const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+            sortedValid_ = true;
+        }
+
+        assert (!sorted_.empty ());
+        // суммарный вес скетча не совпадает с count_ точно — масштабируем ранг
+        uint64_t total = 0;
+        for (auto &item: sorted_)
+            total += item.second;
+        uint64_t target = (uint64_t) ((double) rank / count_ * total);
+
+        uint64_t cumulative = 0;
+        for (auto &[value, weight]: sorted_)
+        {
+            cumulative += weight;
+            if (cumulative >= target)
+                return value;
+        }
+        return sorted_.back ().first;
+    }
+
+    T findMedian () const
+    {
+        return findRank ((count_ + 1) / 2);
+    }
+
+    size_t size () const
+    {
+        return count_;
+    }
+
+    size_t bytes () const
+    {
+        size_t stored = 0;
+        for (auto &level: levels_)
+            stored += level.capacity ();
+        return stored * sizeof (T) + sorted_.capacity () * sizeof (sorted_[0]);
+    }
+};
+
+static_assert (MedianEngine <KLLSketch <int>, int>);
+
+enum Requests
+{
+    ADD = 0,
+    FIND_MEDIAN = 1
+};
+
+template <MedianEngine <int> Engine>
+void solve (Engine &engine)
+{
+    int n;
+    scanf ("%d", &n);
+
+    for (int i = 0; i < n; i++)
+    {
+        int type, arg;
+        scanf ("%d", &type);
+        if (type == FIND_MEDIAN)
+            printf ("%d\n", (int) engine.findMedian ());
+        else if (type == ADD)
+        {
+            scanf ("%d", &arg);
+            engine.insert (arg);
+        }
+    }
+}
+
+/*
+ * Сравнение движков на случайном потоке: insertions вставок, запрос медианы каждые queryEvery вставок.
+ * Печатает пропускную способность, память и ошибку ранга относительно точного ответа.
+ */
+template <MedianEngine <int> Engine>
+void benchmarkEngine (const char *name, Engine engine, const std::vector <int> &stream, int queryEvery)
+{
+    double maxRankError = 0;
+    std::vector <int> medians;
+    medians.reserve (stream.size () / queryEvery + 1);
+
+    auto start = std::chrono::steady_clock::now ();
+    for (size_t i = 0; i < stream.size (); i++)
+    {
+        engine.insert (stream[i]);
+        if ((i + 1) % queryEvery == 0)
+            medians.push_back (engine.findMedian ());
+    }
+    double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+
+    // ошибка ранга: пересчитываем точные ранги вне замера
+    std::vector <int> prefix;
+    for (size_t i = 0, q = 0; i < stream.size (); i++)
+    {
+        prefix.push_back (stream[i]);
+        if ((i + 1) % queryEvery != 0)
+            continue;
+
+        int64_t rank = std::count_if (prefix.begin (), prefix.end (), [&] (int x) { return x < medians[q]; });
+        int64_t wanted = ((int64_t) prefix.size () + 1) / 2 - 1;
+        maxRankError = std::max (maxRankError, (double) std::abs (rank - wanted) / prefix.size ());
+        q++;
+    }
+
+    printf ("%-8s %10.2f Mops/s %10zu bytes  max rank error %.5f\n",
+            name, stream.size () / seconds / 1e6, engine.bytes (), maxRankError);
+}
+
+void benchmarkMedianEngines ()
+{
+    const int N = 1000000, QUERY_EVERY = 10000;
+    std::mt19937 random (42);
+    std::vector <int> stream (N);
+    for (auto &x: stream)
+        x = (int) (random () % 2000000001) - 1000000000;
+
+    benchmarkEngine ("avl", AVLTree <int> (), stream, QUERY_EVERY);
+    benchmarkEngine ("heaps", TwoHeapMedian <int> (), stream, QUERY_EVERY);
+    benchmarkEngine ("kll", KLLSketch <int> (), stream, QUERY_EVERY);
+}
+
 /*int test ()
 {
     AVLTree <int> tree (4);
@@ -242,27 +1052,33 @@ public:
 }*/
 
 
-int main ()
+// Движок выбирается аргументом: avl (по умолчанию), heaps, kll; bench — сравнение движков,
+// concurrent — проверка конкурентного сервиса (код возврата 1 при нарушении)
+int main (int argc, char **argv)
 {
-    int n;
-    scanf ("%d", &n);
-    
-    int type, arg;
-    scanf ("%d %d", &type, &arg);
+    const char *engine = argc > 1 ? argv[1] : "avl";
 
-    AVLTree <int> tree (arg);
+    if (strcmp (engine, "concurrent") == 0)
+        return concurrentMedianDemo () ? 0 : 1;
 
-    for (int i = 1; i < n; i++)
+    if (strcmp (engine, "bench") == 0)
     {
-        scanf ("%d", &type);
-        if (type == AVLTree<int>::Requests::FIND_MEDIAN)
-            printf ("%d\n", tree.findMedian ());
-        else if (type == AVLTree<int>::Requests::ADD)
-        {
-            scanf ("%d", &arg);
-            tree.insert (arg);
-        }
-
+        benchmarkMedianEngines ();
+        return 0;
+    }
+    if (strcmp (engine, "heaps") == 0)
+    {
+        TwoHeapMedian <int> heaps;
+        solve (heaps);
+        return 0;
+    }
+    if (strcmp (engine, "kll") == 0)
+    {
+        KLLSketch <int> sketch;
+        solve (sketch);
+        return 0;
     }
 
+    AVLTree <int> tree;
+    solve (tree);
 }
@@ -1,63 +1,318 @@
 /*
  * Число сочетаний из n по k по простому модулю p
+ *
+ *   combination < "n k p" ... — запросы по одному на строку до конца ввода
+ *
+ * Таблицы факториалов и обратных факториалов строятся один раз на модуль и
+ * наращиваются по мере надобности: запросы пачки группируются по p, а таблицы последних
+ * TABLE_CACHE модулей хранятся между пачками, так что чередование модулей таблиц не перестраивает.
+ * Запрос с n < p — O(1) по таблицам, n >= p — теорема Люка по цифрам n и k в системе счисления p.
+ * Таблица не растёт дальше TABLE_LIMIT = 2^23 элементов: n (или цифра n по Люку) из [2^23, p)
+ * считается прямым произведением binomialDirect за O(min (k, n - k)), а не за O(1).
+ * Арифметика — в форме Монтгомери (p = 2 считается отдельно); деления запросов,
+ * не покрытых таблицей, обращаются одной пачкой.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <stdint.h>
 
+#include "ModularArithmetic.h"
+
+/*
+ * Запросов за одно чтение
+ */
+#define BATCH_SIZE 65536
+
+/*
+ * Больше стольких элементов таблицы не растут (два массива по 8 байт на элемент);
+ * дальше — прямое произведение за O(min (k, n - k))
+ */
+#define TABLE_LIMIT (1ULL << 23)
+
+/*
+ * Сколько таблиц разных модулей хранится одновременно; вытесняется давно не использованная
+ */
+#define TABLE_CACHE 4
+
 /*
- * возвести base в степень power по модулю mod
+ * factorial[i] = i!, inverse[i] = (i!)^-1 по нечётному простому модулю prime для i < size,
+ * оба — в форме Монтгомери
  */
-uint64_t powMod (uint64_t base, uint64_t power, uint64_t mod)
+typedef struct
 {
-    if (power == 0) return 1;
-    uint64_t consol = powMod (base, power / 2, mod);
-    if (power % 2 == 1) return ((base * consol) % mod) * consol % mod;
-    return consol * consol % mod;
+    uint64_t prime;
+    Montgomery mont;
+    uint64_t size, capacity;
+    uint64_t *factorial, *inverse;
+    uint64_t lastUse;
+} FactorialTable;
+
+void tableReset (FactorialTable *table, uint64_t prime)
+{
+    table->prime = prime;
+    table->mont = montgomeryInit (prime);
+    table->size = 0;
 }
 
 /*
- * Найти ret: ret * denominator = numerator (mod modulo), modulo - простое
+ * Таблица модуля prime из кэша; если её нет — место давно не использованной (её буферы
+ * переиспользуются) сбрасывается под prime
  */
-uint64_t divideMod (uint64_t numerator, uint64_t denominator, uint64_t modulo)
+FactorialTable *tableFor (FactorialTable *cache, uint64_t prime, uint64_t tick)
 {
-    return numerator * powMod (denominator, modulo - 2, modulo) % modulo; 
+    FactorialTable *victim = cache;
+    for (FactorialTable *table = cache; table < cache + TABLE_CACHE; table++)
+    {
+        if (table->prime == prime)
+        {
+            table->lastUse = tick;
+            return table;
+        }
+        if (table->lastUse < victim->lastUse) victim = table;
+    }
+    tableReset (victim, prime);
+    victim->lastUse = tick;
+    return victim;
 }
 
-int main ()
+/*
+ * Дорастить таблицу до size элементов. Новые факториалы — продолжением произведения,
+ * обратные — одним обращением для последнего и спуском inverse[i] = inverse[i + 1] * (i + 1)
+ * до старой границы: уже посчитанные элементы не меняются. Множитель i в форме Монтгомери
+ * ведётся сложением, без перевода на каждом шаге
+ */
+void tableReserve (FactorialTable *table, uint64_t size)
 {
-    uint64_t n, k, p;
-    scanf ("%llu %llu %llu", &n ,&k, &p);
+    const Montgomery *m = &table->mont;
 
-    if (n == k)
+    if (size > table->prime) size = table->prime;
+    if (size > TABLE_LIMIT) size = TABLE_LIMIT;
+    if (size <= table->size) return;
+
+    if (size > table->capacity)
     {
-        printf ("1\n");
-        return 0;
+        uint64_t capacity = table->capacity ? table->capacity : 1024;
+        while (capacity < size) capacity *= 2;
+        if (capacity > TABLE_LIMIT) capacity = TABLE_LIMIT;
+        table->factorial = realloc (table->factorial, capacity * sizeof (uint64_t));
+        table->inverse = realloc (table->inverse, capacity * sizeof (uint64_t));
+        assert (table->factorial && table->inverse);
+        table->capacity = capacity;
     }
 
-    if (k > n / 2) k = n - k;
-    assert (k <= n - k);
-    uint64_t i, k_f = 1;
-    for (i = 1; i <= k; i++)
+    uint64_t i = table->size;
+    if (i == 0)
+    {
+        table->factorial[0] = m->one;
+        i = 1;
+    }
+    uint64_t factor = montgomeryTo (m, i);
+    for (; i < size; i++)
+    {
+        table->factorial[i] = montgomeryMul (m, table->factorial[i - 1], factor);
+        factor = montgomeryAdd (m, factor, m->one);
+    }
+
+    table->inverse[size - 1] = montgomeryInverse (m, table->factorial[size - 1]);
+    factor = montgomeryTo (m, size - 1);
+    for (i = size - 1; i > table->size; i--)
+    {
+        table->inverse[i - 1] = montgomeryMul (m, table->inverse[i], factor);
+        factor = montgomeryAdd (m, factor, m->mod - m->one);
+    }
+
+    table->size = size;
+}
+
+/*
+ * C(n, k) при k <= n < p прямым произведением: k членов; знаменатель возвращается отдельно
+ */
+uint64_t binomialDirect (const Montgomery *m, uint64_t n, uint64_t k, uint64_t *denominator)
+{
+    if (k > n - k) k = n - k;
+    uint64_t numerator = m->one, top = montgomeryTo (m, n - k + 1), bottom = m->one;
+    *denominator = m->one;
+    for (uint64_t i = 1; i <= k; i++)
+    {
+        numerator = montgomeryMul (m, numerator, top);
+        *denominator = montgomeryMul (m, *denominator, bottom);
+        top = montgomeryAdd (m, top, m->one);
+        bottom = montgomeryAdd (m, bottom, m->one);
+    }
+    return numerator;
+}
+
+/*
+ * C(n, k) по модулю table->prime как дробь numerator / denominator в форме Монтгомери
+ * (denominator != 1 только если цифра вышла за таблицу); по теореме Люка —
+ * произведение C(n_i, k_i) по цифрам в системе p
+ */
+uint64_t binomialMod (const FactorialTable *table, uint64_t n, uint64_t k, uint64_t *denominator)
+{
+    const Montgomery *m = &table->mont;
+    uint64_t p = table->prime, result = m->one;
+    *denominator = m->one;
+    if (k > n) return 0;
+
+    while (k > 0)
     {
-        k_f *= i;
-        k_f %= p;
+        uint64_t ni = n % p, ki = k % p;
+        if (ki > ni) return 0;
+        if (ni < table->size)
+            result = montgomeryMul (m, result, montgomeryMul (m, table->factorial[ni],
+                                    montgomeryMul (m, table->inverse[ki], table->inverse[ni - ki])));
+        else
+        {
+            uint64_t digitDenominator;
+            result = montgomeryMul (m, result, binomialDirect (m, ni, ki, &digitDenominator));
+            *denominator = montgomeryMul (m, *denominator, digitDenominator);
+        }
+        n /= p;
+        k /= p;
     }
-    uint64_t n_m_k_f = k_f;
-    for (; i <= n - k; i++)
+    return result;
+}
+
+/*
+ * Чтение и вывод через свои буферы: scanf/printf на миллионах запросов дороже самих ответов
+ */
+static char inputBuffer[1 << 16], outputBuffer[1 << 16];
+static size_t inputPos, inputSize, outputSize;
+
+static int readNumber (uint64_t *value)
+{
+    int c;
+    do
+    {
+        if (inputPos == inputSize)
+        {
+            inputSize = fread (inputBuffer, 1, sizeof inputBuffer, stdin);
+            inputPos = 0;
+            if (inputSize == 0) return 0;
+        }
+        c = inputBuffer[inputPos++];
+    } while (c < '0' || c > '9');
+
+    uint64_t x = 0;
+    for (;;)
     {
-        n_m_k_f *= i;
-        n_m_k_f %= p;
+        x = x * 10 + (c - '0');
+        if (inputPos == inputSize)
+        {
+            inputSize = fread (inputBuffer, 1, sizeof inputBuffer, stdin);
+            inputPos = 0;
+            if (inputSize == 0) break;
+        }
+        c = inputBuffer[inputPos];
+        if (c < '0' || c > '9') break;
+        inputPos++;
     }
-    uint64_t n_f = n_m_k_f;
-    for (; i <= n; i++)
+    *value = x;
+    return 1;
+}
+
+static void writeNumber (uint64_t value)
+{
+    if (outputSize + 21 > sizeof outputBuffer)
     {
-        n_f *= i;
-        n_f %= p;
+        fwrite (outputBuffer, 1, outputSize, stdout);
+        outputSize = 0;
     }
+    char digits[20];
+    int length = 0;
+    do
+    {
+        digits[length++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    while (length) outputBuffer[outputSize++] = digits[--length];
+    outputBuffer[outputSize++] = '\n';
+}
 
-    uint64_t denominator = k_f * n_m_k_f % p;
-    printf ("%llu\n", divideMod (n_f, denominator, p));
+/*
+ * Порядок запросов пачки: по модулю, при равных — по номеру
+ */
+static const uint64_t *sortModuli;
 
+static int byModulus (const void *lhs, const void *rhs)
+{
+    size_t a = *(const size_t *) lhs, b = *(const size_t *) rhs;
+    if (sortModuli[a] != sortModuli[b]) return sortModuli[a] < sortModuli[b] ? -1 : 1;
+    return a < b ? -1 : a > b;
+}
+
+int main ()
+{
+    static uint64_t n[BATCH_SIZE], k[BATCH_SIZE], p[BATCH_SIZE], answer[BATCH_SIZE];
+    static uint64_t numerator[BATCH_SIZE], denominator[BATCH_SIZE], scratch[BATCH_SIZE];
+    static size_t order[BATCH_SIZE], pending[BATCH_SIZE];
+    static FactorialTable cache[TABLE_CACHE];
+    uint64_t tick = 0;
+
+    for (;;)
+    {
+        size_t count = 0;
+        while (count < BATCH_SIZE && readNumber (&n[count]) && readNumber (&k[count]) && readNumber (&p[count]))
+        {
+            order[count] = count;
+            count++;
+        }
+        if (count == 0) break;
+
+        sortModuli = p;
+        qsort (order, count, sizeof (size_t), byModulus);
+
+        /* запросы с одним модулем: сначала таблица под самый большой n, потом ответы */
+        for (size_t begin = 0, end; begin < count; begin = end)
+        {
+            uint64_t prime = p[order[begin]], need = 0;
+            for (end = begin; end < count && p[order[end]] == prime; end++)
+            {
+                size_t i = order[end];
+                uint64_t want = n[i] < prime ? n[i] + 1 : prime;
+                if (want > need) need = want;
+            }
+
+            /* по модулю 2 по Люку C(n, k) нечётно ровно тогда, когда биты k — подмножество битов n */
+            if (prime == 2)
+            {
+                for (size_t j = begin; j < end; j++)
+                    answer[order[j]] = (k[order[j]] & ~n[order[j]]) == 0;
+                continue;
+            }
+
+            FactorialTable *table = tableFor (cache, prime, ++tick);
+            tableReserve (table, need);
+
+            size_t fractions = 0;
+            for (size_t j = begin; j < end; j++)
+            {
+                numerator[j] = binomialMod (table, n[order[j]], k[order[j]], &denominator[j]);
+                if (denominator[j] != table->mont.one) pending[fractions++] = j;
+            }
+
+            /* знаменатели нетабличных запросов: одно обращение на всю группу */
+            for (size_t f = 0; f < fractions; f++) denominator[f] = denominator[pending[f]];
+            montgomeryBatchInverse (&table->mont, denominator, scratch, fractions);
+            for (size_t f = 0; f < fractions; f++)
+                numerator[pending[f]] = montgomeryMul (&table->mont, numerator[pending[f]], denominator[f]);
+
+            for (size_t j = begin; j < end; j++)
+                answer[order[j]] = montgomeryFrom (&table->mont, numerator[j]);
+        }
+
+        for (size_t i = 0; i < count; i++)
+            writeNumber (answer[i]);
+
+        if (count < BATCH_SIZE) break;
+    }
+
+    fwrite (outputBuffer, 1, outputSize, stdout);
+    for (size_t t = 0; t < TABLE_CACHE; t++)
+    {
+        free (cache[t].factorial);
+        free (cache[t].inverse);
+    }
 }
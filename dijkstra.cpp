@@ -0,0 +1,311 @@
+/*
+ * Кратчайшие пути во взвешенном графе: Dijkstra (на всё или до одной вершины с ранним выходом),
+ * двунаправленный Dijkstra и A* с подключаемой эвристикой.
+ */
+#include "WeightedGraph.hpp"
+#include "CSRGraph.hpp"
+#include "IndexedHeap.hpp"
+#include <limits>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+/*
+ * Движок запросов кратчайших путей. Веса неотрицательны, граф неориентированный.
+ * Все рабочие массивы (расстояния, предки, 4-арные кучи) выделяются один раз;
+ * после запроса сбрасываются только затронутые вершины, так что серия запросов
+ * на большом графе не платит O(V) за каждый.
+ */
+template <typename WeightT, template <typename> class Graph = WeightedGraph>
+class ShortestPaths
+{
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Search
+    {
+        std::vector <WeightT> dist;
+        std::vector <uint32_t> parent;
+        std::vector <bool> settled;
+        std::vector <uint32_t> touched;
+        IndexedHeap <WeightT, 4> heap;
+
+        explicit Search (size_t n):
+            dist (n, INF),
+            parent (n, NONE),
+            settled (n, false),
+            heap (n)
+        {}
+
+        void reset ()
+        {
+            for (uint32_t v: touched)
+            {
+                dist[v] = INF;
+                parent[v] = NONE;
+                settled[v] = false;
+            }
+            touched.clear ();
+            heap.clear ();
+        }
+
+        void start (size_t s)
+        {
+            touched.push_back ((uint32_t) s);
+            dist[s] = WeightT { };
+            heap.push (s, WeightT { });
+        }
+
+        // Релаксирует рёбра u; key (v, d) — ключ v в куче при расстоянии d
+        template <typename Key>
+        void relax (const Graph<WeightT> &g, size_t u, Key key)
+        {
+            for (auto [v, weight]: g.getNeibs(u))
+            {
+                WeightT candidate = dist[u] + weight;
+                if (settled[v] || !(candidate < dist[v]))
+                    continue;
+
+                if (dist[v] == INF)
+                    touched.push_back ((uint32_t) v);
+                dist[v] = candidate;
+                parent[v] = (uint32_t) u;
+                heap.pushOrDecrease (v, key (v, candidate));
+            }
+        }
+    };
+
+    const Graph<WeightT> &g_;
+    Search forward_, backward_;
+    uint32_t source_, target_;
+
+    // Для двунаправленного поиска: ребро (сторона s, сторона t) на лучшем пути
+    bool twoSided_;
+    std::pair <uint32_t, uint32_t> link_;
+
+    void prepare (size_t s, size_t t, bool twoSided)
+    {
+        forward_.reset ();
+        backward_.reset ();
+        source_ = (uint32_t) s;
+        target_ = (uint32_t) t;
+        twoSided_ = twoSided;
+        link_ = {NONE, NONE};
+    }
+
+public:
+
+    static constexpr WeightT INF = std::numeric_limits<WeightT>::max ();
+
+    explicit ShortestPaths (const Graph<WeightT> &g):
+        g_ (g),
+        forward_ (g.size ()),
+        backward_ (g.size ()),
+        source_ (NONE), target_ (NONE),
+        twoSided_ (false),
+        link_ {NONE, NONE}
+    {}
+
+    // Расстояния от s до всех вершин; доступны через distance (v)
+    void singleSource (size_t s)
+    {
+        prepare (s, NONE, false);
+        forward_.start (s);
+        while (!forward_.heap.empty ())
+        {
+            size_t u = forward_.heap.pop ();
+            forward_.settled[u] = true;
+            forward_.relax (g_, u, [] (size_t, WeightT d) { return d; });
+        }
+    }
+
+    // Расстояние от s до t с остановкой, как только t извлечена из кучи (INF, если недостижима)
+    WeightT query (size_t s, size_t t)
+    {
+        return aStar (s, t, [] (size_t) { return WeightT { }; });
+    }
+
+    // A*: heuristic (v) — нижняя оценка расстояния от v до t, должна быть согласованной
+    // (h (u) <= w (u, v) + h (v)), иначе ответ может оказаться неоптимальным
+    template <typename Heuristic>
+    WeightT aStar (size_t s, size_t t, Heuristic heuristic)
+    {
+        prepare (s, t, false);
+        forward_.start (s);
+        while (!forward_.heap.empty ())
+        {
+            size_t u = forward_.heap.pop ();
+            forward_.settled[u] = true;
+            if (u == t)
+                break;
+            forward_.relax (g_, u, [&] (size_t v, WeightT d) { return d + heuristic (v); });
+        }
+        return forward_.dist[t];
+    }
+
+    // Двунаправленный Dijkstra: поиски от s и от t чередуются по меньшему ключу и
+    // останавливаются, когда сумма вершин куч не меньше лучшего найденного пути
+    WeightT bidirectional (size_t s, size_t t)
+    {
+        prepare (s, t, true);
+        forward_.start (s);
+        backward_.start (t);
+
+        WeightT best = s == t ? WeightT { } : INF;
+
+        while (!forward_.heap.empty () && !backward_.heap.empty ())
+        {
+            WeightT topForward = forward_.heap.key (forward_.heap.top ());
+            WeightT topBackward = backward_.heap.key (backward_.heap.top ());
+            if (best != INF && !(topForward + topBackward < best))
+                break;
+
+            bool forwardStep = !(topBackward < topForward);
+            Search &search = forwardStep ? forward_ : backward_;
+            Search &other = forwardStep ? backward_ : forward_;
+
+            size_t u = search.heap.pop ();
+            search.settled[u] = true;
+            search.relax (g_, u, [] (size_t, WeightT d) { return d; });
+
+            // каждое ребро из u могло замкнуть путь через уже достигнутую другим поиском вершину
+            for (auto [v, weight]: g_.getNeibs(u))
+            {
+                if (other.dist[v] == INF)
+                    continue;
+                WeightT candidate = search.dist[u] + weight + other.dist[v];
+                if (candidate < best)
+                {
+                    best = candidate;
+                    link_ = forwardStep ? std::pair {(uint32_t) u, (uint32_t) v} : std::pair {(uint32_t) v, (uint32_t) u};
+                }
+            }
+        }
+
+        return best;
+    }
+
+    // Расстояние до v после singleSource
+    inline WeightT distance (size_t v) const
+    {
+        return forward_.dist[v];
+    }
+
+    // Путь последнего запроса от источника до v (до t для точечных запросов); пуст, если пути нет
+    std::vector <size_t> path (size_t v = NONE) const
+    {
+        std::vector <size_t> result;
+
+        if (!twoSided_)
+        {
+            if (v == NONE)
+                v = target_;
+            if (v == NONE || forward_.dist[v] == INF)
+                return result;
+            for (size_t x = v; x != NONE; x = forward_.parent[x])
+                result.push_back (x);
+            std::reverse (result.begin (), result.end ());
+            return result;
+        }
+
+        if (source_ == target_)
+            return {source_};
+        if (link_.first == NONE)
+            return result;
+
+        auto [sSide, tSide] = link_;
+        for (size_t x = sSide; x != NONE; x = forward_.parent[x])
+            result.push_back (x);
+        std::reverse (result.begin (), result.end ());
+        for (size_t x = tSide; x != NONE; x = backward_.parent[x])
+            result.push_back (x);
+        return result;
+    }
+};
+
+// Граф-решётка width x height со случайными весами >= 1 (для A* с манхэттенской эвристикой)
+WeightedGraph<int> gridGraph (size_t width, size_t height, unsigned seed)
+{
+    std::mt19937 random (seed);
+    WeightedGraph<int> g (width * height);
+    for (size_t y = 0; y < height; y++)
+    for (size_t x = 0; x < width; x++)
+    {
+        size_t u = y * width + x;
+        if (x + 1 < width)  g.insert (u, u + 1, 1 + random () % 10);
+        if (y + 1 < height) g.insert (u, u + width, 1 + random () % 10);
+    }
+    return g;
+}
+
+void benchmarkShortestPaths ()
+{
+    const size_t SIDE = 1000, QUERIES = 100;
+
+    CSRGraph<int> g (gridGraph (SIDE, SIDE, 1));
+    ShortestPaths<int, CSRGraph> engine (g);
+
+    std::mt19937 random (2);
+    std::vector <std::pair <size_t, size_t>> queries (QUERIES);
+    for (auto &[s, t]: queries)
+    {
+        s = random () % g.size ();
+        t = random () % g.size ();
+    }
+
+    auto manhattan = [] (size_t t) {
+        return [t] (size_t v) {
+            return (int) (std::abs ((long) (v % SIDE) - (long) (t % SIDE)) + std::abs ((long) (v / SIDE) - (long) (t / SIDE)));
+        };
+    };
+
+    const char *names[] = {"dijkstra", "bidirectional", "a*"};
+    for (int method = 0; method < 3; method++)
+    {
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now ();
+        for (auto [s, t]: queries)
+        {
+            if (method == 0) checksum += engine.query (s, t);
+            if (method == 1) checksum += engine.bidirectional (s, t);
+            if (method == 2) checksum += engine.aStar (s, t, manhattan (t));
+        }
+        double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+        printf ("%-14s %8.3f ms/query  checksum %lld\n", names[method], seconds * 1000 / QUERIES, checksum);
+    }
+}
+
+int main (int argc, char **argv)
+{
+    if (argc > 1 && strcmp (argv[1], "bench") == 0)
+    {
+        benchmarkShortestPaths ();
+        return 0;
+    }
+
+    WeightedGraph<int> g (8);
+    g.insert (0, 2, 7);
+    g.insert (0, 1, 10);
+    g.insert (0, 5, 26);
+    g.insert (0, 6, 20);
+    g.insert (0, 7, 9);
+    g.insert (4, 6, 30);
+    g.insert (4, 7, 22);
+    g.insert (4, 3, 11);
+    g.insert (4, 5, 15);
+    g.insert (1, 7, 7);
+    g.insert (6, 7, 10);
+    g.insert (3, 5, 4);
+
+    ShortestPaths<int> engine (g);
+    engine.singleSource (0);
+    for (size_t v = 0; v < g.size (); ++v)
+        printf ("dist (0, %lu) = %d\n", v, engine.distance (v));
+
+    printf ("dist (2, 3) = %d:", engine.bidirectional (2, 3));
+    for (auto v: engine.path ())
+        printf (" %lu", v);
+    printf ("\n");
+}
@@ -0,0 +1,86 @@
+/*
+ * Поддержка минимального остовного леса при изменении стоимостей связей:
+ * случайный поток вставок и удалений, ответ сверяется с пересчётом getMSTKruskal с нуля.
+ *
+ *   dynamic-mst [vertices] [operations] [checkEvery]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <chrono>
+#include "WeightedGraph.hpp"
+#include "DynamicMST.hpp"
+#include "MST.hpp"
+
+int main (int argc, char **argv)
+{
+    size_t n = argc > 1 ? atol (argv[1]) : 1000;
+    size_t operations = argc > 2 ? atol (argv[2]) : 200000;
+    size_t checkEvery = argc > 3 ? atol (argv[3]) : 1000;
+
+    // рёбра веса lowest (): вершины пути не должны выигрывать у них максимум
+    {
+        DynamicMST<unsigned> zero (3);
+        zero.insert (0, 1, 0);
+        zero.insert (1, 2, 0);
+        zero.insert (0, 2, 5);
+        if (zero.weight () != 0 || zero.treeEdges () != 2)
+        {
+            printf ("zero-weight edges: forest weight %u (%zu edges), expected 0 (2 edges)\n",
+                    zero.weight (), zero.treeEdges ());
+            return 1;
+        }
+    }
+
+    std::mt19937_64 random (1);
+    WeightedGraph<long long> g (n);
+    DynamicMST<long long> mst (n);
+    std::vector <std::pair <size_t, size_t>> present;
+
+    double updateSeconds = 0;
+    size_t checks = 0;
+
+    for (size_t op = 1; op <= operations; op++)
+    {
+        // смена стоимости связи — удаление и вставка; держим рёбер примерно 4n
+        bool remove = !present.empty () && random () % (8 * n) < present.size ();
+
+        auto start = std::chrono::steady_clock::now ();
+        if (remove)
+        {
+            size_t i = random () % present.size ();
+            auto [u, v] = present[i];
+            present[i] = present.back ();
+            present.pop_back ();
+
+            mst.erase (u, v);
+            g.erase (u, v);
+        }
+        else
+        {
+            size_t u = random () % n, v = random () % n;
+            long long weight = 1 + random () % 1000000;
+            if (mst.insert (u, v, weight))
+            {
+                g.insert (u, v, weight);
+                present.push_back ({u, v});
+            }
+        }
+        updateSeconds += std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+
+        if (op % checkEvery == 0)
+        {
+            long long expected = totalWeight (getMSTKruskal (g, 1));
+            if (expected != mst.weight ())
+            {
+                printf ("mismatch after %zu operations: dynamic %lld, recomputed %lld\n", op, mst.weight (), expected);
+                return 1;
+            }
+            checks++;
+        }
+    }
+
+    printf ("%zu operations on %zu vertices: %.2f us/update, %zu checks against full recompute passed, "
+            "forest weight %lld (%zu edges)\n",
+            operations, n, updateSeconds / operations * 1e6, checks, mst.weight (), mst.treeEdges ());
+}
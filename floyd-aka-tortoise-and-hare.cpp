@@ -1,9 +1,21 @@
 /*
  * Использование алгоритма Флойда для перевода обыкновенной дроби в десятичное периодическое представление
+ *
+ *   floyd-aka-tortoise-and-hare [maxDigits] < "numerator denominator"
+ *   floyd-aka-tortoise-and-hare walk < "numerator denominator" — то же обходом последовательности остатков Флойдом
+ *   floyd-aka-tortoise-and-hare period < "numerator denominator" — только длины предпериода и периода
+ *   floyd-aka-tortoise-and-hare bench [sequences] [modulus] — Флойд, Брент и пакетный Брент на хеш-цепочках
  */
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "NumberTheory.hpp"
 
 struct NextDigit
 {
@@ -19,8 +31,10 @@ struct FuncTraits
     Param period, predperiod;
 };
 
-template <typename Param, typename Func, typename... Args>
-FuncTraits<Param> floyd (Param x0, Args&... args)
+// Функтор с состоянием передаётся по ссылке и используется один на весь поиск
+// (счётчик вызовов, кэш, состояние генератора)
+template <typename Func, typename Param, typename... Args>
+FuncTraits<Param> floyd (Func &&func, Param x0, Args&&... args)
 {
     FuncTraits<Param> ret { };
 
@@ -29,22 +43,22 @@ FuncTraits<Param> floyd (Param x0, Args&... args)
 
     do 
     {
-        tortoise = Func() (tortoise, args...);
-        hare = Func()(Func() (hare, args...), args...);
+        tortoise = func (tortoise, args...);
+        hare = func (func (hare, args...), args...);
     } while (tortoise != hare);
 
     hare = x0;
     
     while (tortoise != hare)
     {
-        hare = Func() (hare, args...);
-        tortoise = Func() (tortoise, args...);
+        hare = func (hare, args...);
+        tortoise = func (tortoise, args...);
         ret.predperiod++;
     }
 
     do
     {
-        hare = Func() (hare, args...);
+        hare = func (hare, args...);
         ret.period++;
     } while (tortoise != hare);
     
@@ -52,33 +66,348 @@ FuncTraits<Param> floyd (Param x0, Args&... args)
 
 }
 
-int main ()
+template <typename Param, typename Func, typename... Args>
+FuncTraits<Param> floyd (Param x0, Args&... args)
 {
-    int numerator,denominator;
-    scanf ("%d %d", &numerator, &denominator);
+    Func func;
+    return floyd (func, x0, args...);
+}
 
-    printf ("%d,", numerator / denominator);
-    
-    numerator = numerator % denominator;
+// Алгоритм Брента: заяц идёт по одному шагу, черепаха перепрыгивает к нему на степенях двойки.
+// Длину цикла находит сразу, без третьего прохода; вызовов func в среднем заметно меньше, чем у Флойда
+template <typename Func, typename Param, typename... Args>
+FuncTraits<Param> brent (Func &&func, Param x0, Args&&... args)
+{
+    FuncTraits<Param> ret { };
+
+    Param power = 1;
+    ret.period = 1;
+
+    Param tortoise = x0;
+    Param hare = func (x0, args...);
+
+    while (tortoise != hare)
+    {
+        if (power == ret.period)
+        {
+            tortoise = hare;
+            power *= 2;
+            ret.period = 0;
+        }
+        hare = func (hare, args...);
+        ret.period++;
+    }
+
+    tortoise = hare = x0;
+    for (Param i = 0; i < ret.period; i++)
+        hare = func (hare, args...);
+
+    while (tortoise != hare)
+    {
+        tortoise = func (tortoise, args...);
+        hare = func (hare, args...);
+        ret.predperiod++;
+    }
+
+    return ret;
+}
+
+template <typename Param, typename Func, typename... Args>
+FuncTraits<Param> brent (Param x0, Args&... args)
+{
+    Func func;
+    return brent (func, x0, args...);
+}
+
+// Алгоритм Брента для многих начальных значений сразу: последовательности идут группами по LANES
+// в общем цикле, и независимые вызовы func соседних дорожек перекрываются во времени —
+// для дорогих шагов (цепочки хешей, переходы генераторов) это скрывает их задержку
+template <typename Func, typename Param, typename... Args>
+void brentBatch (Func &&func, const Param *x0, size_t count, FuncTraits<Param> *result, Args&&... args)
+{
+    const size_t LANES = 8;
+
+    for (size_t base = 0; base < count; base += LANES)
+    {
+        size_t lanes = std::min (LANES, count - base);
+        Param tortoise[LANES], hare[LANES], power[LANES], period[LANES], predperiod[LANES];
+        bool found[LANES];
+        size_t active = lanes;
+
+        for (size_t l = 0; l < lanes; l++)
+        {
+            tortoise[l] = x0[base + l];
+            hare[l] = func (tortoise[l], args...);
+            power[l] = period[l] = 1;
+            predperiod[l] = 0;
+            found[l] = tortoise[l] == hare[l];
+            active -= found[l];
+        }
+
+        while (active > 0)
+            for (size_t l = 0; l < lanes; l++)
+            {
+                if (found[l])
+                    continue;
+                if (power[l] == period[l])
+                {
+                    tortoise[l] = hare[l];
+                    power[l] *= 2;
+                    period[l] = 0;
+                }
+                hare[l] = func (hare[l], args...);
+                period[l]++;
+                if (tortoise[l] == hare[l])
+                {
+                    found[l] = true;
+                    active--;
+                }
+            }
+
+        // заяц уходит на period шагов вперёд, затем оба идут до встречи в начале цикла
+        Param longest = 0;
+        for (size_t l = 0; l < lanes; l++)
+        {
+            tortoise[l] = hare[l] = x0[base + l];
+            longest = std::max (longest, period[l]);
+        }
+        for (Param i = 0; i < longest; i++)
+            for (size_t l = 0; l < lanes; l++)
+                if (i < period[l])
+                    hare[l] = func (hare[l], args...);
+
+        active = lanes;
+        for (size_t l = 0; l < lanes; l++)
+        {
+            found[l] = tortoise[l] == hare[l];
+            active -= found[l];
+        }
+        while (active > 0)
+            for (size_t l = 0; l < lanes; l++)
+            {
+                if (found[l])
+                    continue;
+                tortoise[l] = func (tortoise[l], args...);
+                hare[l] = func (hare[l], args...);
+                predperiod[l]++;
+                if (tortoise[l] == hare[l])
+                {
+                    found[l] = true;
+                    active--;
+                }
+            }
+
+        for (size_t l = 0; l < lanes; l++)
+            result[base + l] = {period[l], predperiod[l]};
+    }
+}
+
+// Шаг «дорогой» последовательности: несколько раундов перемешивания 64-битного состояния
+// по модулю m; считает свои вызовы
+struct HashStep
+{
+    uint64_t calls = 0;
+
+    uint64_t operator () (uint64_t x, uint64_t m)
+    {
+        calls++;
+        for (int round = 0; round < 4; round++)
+        {
+            x ^= x >> 31;
+            x *= 0x9E3779B97F4A7C15ULL;
+        }
+        return x % m;
+    }
+};
+
+void benchmark (size_t starts, uint64_t m)
+{
+    std::vector <uint64_t> x0 (starts);
+    for (size_t i = 0; i < starts; i++)
+        x0[i] = i * 7919 % m;
+
+    std::vector <FuncTraits<uint64_t>> floydResult (starts), brentResult (starts), batchResult (starts);
+    HashStep floydStep, brentStep, batchStep;
+
+    auto time = [] (auto body) {
+        auto start = std::chrono::steady_clock::now ();
+        body ();
+        return std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+    };
+
+    double floydTime = time ([&] { for (size_t i = 0; i < starts; i++) floydResult[i] = floyd (floydStep, x0[i], m); });
+    double brentTime = time ([&] { for (size_t i = 0; i < starts; i++) brentResult[i] = brent (brentStep, x0[i], m); });
+    double batchTime = time ([&] { brentBatch (batchStep, x0.data (), starts, batchResult.data (), m); });
+
+    bool same = true;
+    for (size_t i = 0; i < starts; i++)
+        same &= floydResult[i].period == brentResult[i].period && floydResult[i].predperiod == brentResult[i].predperiod &&
+                brentResult[i].period == batchResult[i].period && brentResult[i].predperiod == batchResult[i].predperiod;
 
-    auto [period, predperiod] = floyd <int, NextDigit, int> (numerator, denominator);
+    printf ("%zu sequences mod %llu\n", starts, (unsigned long long) m);
+    printf ("  floyd        %.3f s, %llu calls\n", floydTime, (unsigned long long) floydStep.calls);
+    printf ("  brent        %.3f s, %llu calls\n", brentTime, (unsigned long long) brentStep.calls);
+    printf ("  brent batch  %.3f s, %llu calls%s\n", batchTime, (unsigned long long) batchStep.calls, same ? "" : "  MISMATCH");
+}
+
+// Разложение n / d без обхода цикла. Пусть q = d / gcd (n mod d, d) = 2^a 5^b q', gcd (q', 10) = 1.
+// Предпериод — max (a, b) цифр, период — порядок 10 по модулю q' (для q' = 1 дробь конечна)
+struct FractionExpansion
+{
+    uint64_t integer, remainder, denominator;
+    uint64_t predperiod, period;
+};
+
+FractionExpansion expandFraction (uint64_t numerator, uint64_t denominator)
+{
+    FractionExpansion ret {numerator / denominator, numerator % denominator, denominator, 0, 0};
+
+    uint64_t q = denominator / std::gcd (ret.remainder, denominator);
+    uint64_t twos = 0, fives = 0;
+    for (; q % 2 == 0; q /= 2)
+        twos++;
+    for (; q % 5 == 0; q /= 5)
+        fives++;
 
-    for (int i = 0; i < predperiod; i++)
+    ret.predperiod = std::max (twos, fives);
+    ret.period = q == 1 ? 0 : multiplicativeOrder (10, q);
+    return ret;
+}
+
+// Буферизованный вывод цифр: блоками через fwrite вместо printf на каждую цифру
+class DigitWriter
+{
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    char buffer_[BUFFER_SIZE];
+    size_t size_ = 0;
+
+public:
+    ~DigitWriter ()
     {
-        printf ("%d", 10 * numerator / denominator);
-        numerator = NextDigit() (numerator, denominator);
+        flush ();
     }
 
-    if (numerator == 0 && period == 1) 
+    void flush ()
     {
-        printf ("\n");
+        fwrite (buffer_, 1, size_, stdout);
+        size_ = 0;
+    }
+
+    void put (char c)
+    {
+        if (size_ == BUFFER_SIZE)
+            flush ();
+        buffer_[size_++] = c;
+    }
+
+    void put (const char *s)
+    {
+        for (; *s; s++)
+            put (*s);
+    }
+
+    // Число value ровно из width цифр с ведущими нулями
+    void putFixed (uint64_t value, int width)
+    {
+        if (size_ + width > BUFFER_SIZE)
+            flush ();
+        for (int i = width - 1; i >= 0; i--, value /= 10)
+            buffer_[size_ + i] = '0' + value % 10;
+        size_ += width;
+    }
+};
+
+// count очередных цифр долгого деления remainder / denominator. За один шаг — 19 цифр:
+// remainder * 10^19 помещается в 128 бит, частное — в 64
+void writeDigits (DigitWriter &writer, uint64_t &remainder, uint64_t denominator, uint64_t count)
+{
+    const int CHUNK = 19;
+    uint64_t power[CHUNK + 1] = {1};
+    for (int i = 1; i <= CHUNK; i++)
+        power[i] = power[i - 1] * 10;
+
+    for (; count > 0; )
+    {
+        int width = (int) std::min <uint64_t> (count, CHUNK);
+        unsigned __int128 value = (unsigned __int128) remainder * power[width];
+        writer.putFixed ((uint64_t) (value / denominator), width);
+        remainder = (uint64_t) (value % denominator);
+        count -= width;
+    }
+}
+
+int main (int argc, char **argv)
+{
+    if (argc > 1 && !strcmp (argv[1], "bench"))
+    {
+        benchmark (argc > 2 ? atol (argv[2]) : 10000, argc > 3 ? strtoull (argv[3], nullptr, 10) : 1000000);
+        return 0;
+    }
+
+    if (argc > 1 && !strcmp (argv[1], "walk"))
+    {
+        int numerator,denominator;
+        scanf ("%d %d", &numerator, &denominator);
+
+        printf ("%d,", numerator / denominator);
+
+        numerator = numerator % denominator;
+
+        auto [period, predperiod] = floyd <int, NextDigit, int> (numerator, denominator);
+
+        for (int i = 0; i < predperiod; i++)
+        {
+            printf ("%d", 10 * numerator / denominator);
+            numerator = NextDigit() (numerator, denominator);
+        }
+
+        if (numerator == 0 && period == 1)
+        {
+            printf ("\n");
+            return 0;
+        }
+        printf ("(");
+        for (int i = 0; i < period; i++)
+        {
+            printf ("%d", 10 * numerator / denominator);
+            numerator = NextDigit() (numerator, denominator);
+        }
+        printf (")\n");
         return 0;
     }
-    printf ("(");
-    for (int i = 0; i < period; i++)
+
+    unsigned long long numerator, denominator;
+    if (scanf ("%llu %llu", &numerator, &denominator) != 2 || denominator == 0)
+        return 1;
+
+    FractionExpansion fraction = expandFraction (numerator, denominator);
+
+    if (argc > 1 && !strcmp (argv[1], "period"))
     {
-        printf ("%d", 10 * numerator / denominator);
-        numerator = NextDigit() (numerator, denominator);
+        printf ("%llu %llu\n", (unsigned long long) fraction.predperiod, (unsigned long long) fraction.period);
+        return 0;
+    }
+
+    // период длиннее maxDigits обрезается многоточием
+    uint64_t maxDigits = argc > 1 ? strtoull (argv[1], nullptr, 10) : UINT64_MAX;
+
+    DigitWriter writer;
+    char integer[32];
+    snprintf (integer, sizeof integer, "%llu,", (unsigned long long) fraction.integer);
+    writer.put (integer);
+
+    uint64_t remainder = fraction.remainder;
+    writeDigits (writer, remainder, denominator, fraction.predperiod);
+
+    if (fraction.period == 0)
+    {
+        writer.put ('\n');
+        return 0;
     }
-    printf (")\n");
+    writer.put ('(');
+    writeDigits (writer, remainder, denominator, std::min (fraction.period, maxDigits));
+    if (fraction.period > maxDigits)
+        writer.put ("...");
+    writer.put (")\n");
 }
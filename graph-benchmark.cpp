@@ -0,0 +1,332 @@
+/*
+ * Бенчмарк графовых алгоритмов на синтетических графах.
+ *
+ *   graph-benchmark [-g er|rmat|grid|dag|powerlaw] [-s scale] [-d degree] [-a algo,algo,...]
+ *                   [-r repeats] [--seed N] [--csv]
+ *
+ * Граф имеет 2^scale вершин (решётка — 2^(scale/2) x 2^(scale - scale/2)) и около degree * 2^scale рёбер.
+ * Алгоритмы: bfs, pbfs (параллельный BFS), dfs, scc, topo (Kahn по уровням), prim, kruskal, boruvka, all.
+ * На каждый прогон печатается одна строка JSON (или CSV с --csv): время, рёбер в секунду, пиковый RSS
+ * и аппаратные счётчики (cycles, instructions, cache-misses, branch-misses), если доступен perf_event;
+ * иначе счётчики — null. Формат рассчитан на сравнение прогонов скриптом.
+ */
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "UnweightedGraph.hpp"
+#include "CSRGraph.hpp"
+#include "MST.hpp"
+#include "GraphGenerators.hpp"
+
+/*
+ * Группа аппаратных счётчиков perf_event для текущего потока и потоков, созданных после
+ * конструктора. Если ядро или права не позволяют (perf_event_paranoid, контейнер),
+ * available () == false и бенчмарк работает без счётчиков.
+ */
+class PerfCounters
+{
+    static const int COUNT = 4;
+    int fds_[COUNT];
+    bool available_;
+
+    static int open (uint64_t config, int group)
+    {
+        perf_event_attr attr { };
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof (attr);
+        attr.config = config;
+        attr.disabled = group == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        return (int) syscall (SYS_perf_event_open, &attr, 0, -1, group, 0);
+    }
+
+public:
+
+    static constexpr const char *NAMES[COUNT] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+    PerfCounters ():
+        available_ (true)
+    {
+        const uint64_t CONFIGS[COUNT] =
+        {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for (int i = 0; i < COUNT; i++)
+        {
+            fds_[i] = open (CONFIGS[i], i == 0 ? -1 : fds_[0]);
+            if (fds_[i] < 0)
+                available_ = false;
+        }
+    }
+
+    ~PerfCounters ()
+    {
+        for (int fd: fds_)
+            if (fd >= 0)
+                close (fd);
+    }
+
+    inline bool available () const { return available_; }
+
+    void start ()
+    {
+        if (!available_) return;
+        ioctl (fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl (fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    void stop (uint64_t values[COUNT])
+    {
+        for (int i = 0; i < COUNT; i++)
+            values[i] = 0;
+        if (!available_) return;
+
+        ioctl (fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        for (int i = 0; i < COUNT; i++)
+            if (read (fds_[i], &values[i], sizeof (uint64_t)) != sizeof (uint64_t))
+                values[i] = 0;
+    }
+};
+
+// Сбросить пиковый RSS процесса (Linux >= 4.0); без этого VmHWM — максимум за всё время жизни
+void resetPeakRss ()
+{
+    FILE *file = fopen ("/proc/self/clear_refs", "w");
+    if (file)
+    {
+        fputs ("5", file);
+        fclose (file);
+    }
+}
+
+size_t peakRssKb ()
+{
+    FILE *file = fopen ("/proc/self/status", "r");
+    if (file == nullptr)
+        return 0;
+
+    char line[256];
+    size_t kb = 0;
+    while (fgets (line, sizeof (line), file))
+        if (strncmp (line, "VmHWM:", 6) == 0)
+            kb = strtoull (line + 6, nullptr, 10);
+    fclose (file);
+    return kb;
+}
+
+struct Options
+{
+    std::string generator = "er";
+    unsigned scale = 16;
+    size_t degree = 8;
+    std::string algorithms = "all";
+    unsigned repeats = 3;
+    unsigned seed = 1;
+    bool csv = false;
+};
+
+struct Workload
+{
+    size_t vertices;
+    GeneratedEdges edges;
+    bool directed;
+};
+
+Workload generate (const Options &options)
+{
+    size_t n = (size_t) 1 << options.scale;
+    const std::string &name = options.generator;
+
+    if (name == "rmat")
+        return {n, rmatEdges (options.scale, options.degree, options.seed), false};
+    if (name == "grid")
+    {
+        size_t width = (size_t) 1 << (options.scale / 2), height = n / width;
+        return {n, gridEdges (width, height, options.seed), false};
+    }
+    if (name == "dag")
+        return {n, randomDagEdges (n, n * options.degree, options.seed), true};
+    if (name == "powerlaw")
+        return {n, powerLawEdges (n, options.degree, options.seed), false};
+    return {n, erdosRenyiEdges (n, n * options.degree, options.seed), false};
+}
+
+void report (const Options &options, const Workload &workload, const char *algorithm, unsigned run,
+             double seconds, size_t edgesTouched, size_t rssKb, bool counters, const uint64_t values[4])
+{
+    double edgesPerSecond = edgesTouched / seconds;
+
+    if (options.csv)
+    {
+        printf ("%s,%u,%zu,%zu,%s,%u,%.6f,%.0f,%zu", options.generator.c_str (), options.scale, workload.vertices,
+                workload.edges.size (), algorithm, run, seconds, edgesPerSecond, rssKb);
+        for (int i = 0; i < 4; i++)
+            counters ? printf (",%llu", (unsigned long long) values[i]) : printf (",");
+        printf ("\n");
+        return;
+    }
+
+    printf ("{\"generator\":\"%s\",\"scale\":%u,\"vertices\":%zu,\"edges\":%zu,\"algorithm\":\"%s\",\"run\":%u,"
+            "\"threads\":%u,\"seconds\":%.6f,\"edges_per_sec\":%.0f,\"peak_rss_kb\":%zu",
+            options.generator.c_str (), options.scale, workload.vertices, workload.edges.size (), algorithm, run,
+            std::thread::hardware_concurrency (), seconds, edgesPerSecond, rssKb);
+    for (int i = 0; i < 4; i++)
+    {
+        if (counters)
+            printf (",\"%s\":%llu", PerfCounters::NAMES[i], (unsigned long long) values[i]);
+        else
+            printf (",\"%s\":null", PerfCounters::NAMES[i]);
+    }
+    printf ("}\n");
+    fflush (stdout);
+}
+
+bool wanted (const Options &options, const char *algorithm)
+{
+    if (options.algorithms == "all")
+        return true;
+
+    std::string list = "," + options.algorithms + ",";
+    return list.find (std::string (",") + algorithm + ",") != std::string::npos;
+}
+
+int main (int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        auto next = [&] { return i + 1 < argc ? argv[++i] : ""; };
+        if      (strcmp (argv[i], "-g") == 0) options.generator = next ();
+        else if (strcmp (argv[i], "-s") == 0) options.scale = atoi (next ());
+        else if (strcmp (argv[i], "-d") == 0) options.degree = atoi (next ());
+        else if (strcmp (argv[i], "-a") == 0) options.algorithms = next ();
+        else if (strcmp (argv[i], "-r") == 0) options.repeats = atoi (next ());
+        else if (strcmp (argv[i], "--seed") == 0) options.seed = atoi (next ());
+        else if (strcmp (argv[i], "--csv") == 0) options.csv = true;
+        else
+        {
+            fprintf (stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Workload workload = generate (options);
+    size_t n = workload.vertices;
+
+    // Невзвешенный граф для обходов: неориентированные рёбра кладутся в обе стороны
+    BasicUnweightedGraph <SmallSortedVector <>> g (n);
+    for (auto &edge: workload.edges)
+    {
+        g.insert (edge.u, edge.v);
+        if (!workload.directed)
+            g.insert (edge.v, edge.u);
+    }
+    size_t arcs = 0;
+    for (size_t u = 0; u < n; u++)
+        arcs += g.getNeibs(u).size ();
+
+    CSRGraph<int> weighted (n, workload.edges);
+    // inherit распространяется только на потоки, созданные после открытия счётчиков
+    PerfCounters counters;
+    ThreadPool pool;
+
+    if (options.csv)
+        printf ("generator,scale,vertices,edges,algorithm,run,seconds,edges_per_sec,peak_rss_kb,"
+                "cycles,instructions,cache_misses,branch_misses\n");
+
+    // edgesTouched вызывается после замера: для обходов считает рёбра достигнутых вершин
+    struct Algorithm
+    {
+        const char *name;
+        std::function <void ()> run;
+        std::function <size_t ()> edgesTouched;
+    };
+
+    // Отмечает достигнутые вершины; вызовы для разных v независимы, так что годится и для ParallelBfs
+    struct Visit
+    {
+        std::vector <char> *reached;
+        void operator () (int v, int) { (*reached)[v] = 1; }
+    };
+    struct Enter
+    {
+        std::vector <bool> *seen;
+        bool operator () (size_t u) { bool old = (*seen)[u]; (*seen)[u] = true; return old; }
+    };
+    struct Exit
+    {
+        void operator () (size_t) {}
+    };
+
+    size_t sink = 0;
+    ParallelBfs <decltype (g)> parallel (g, pool);
+
+    // Обходы начинаются с вершины наибольшей степени, чтобы не застрять в мелкой компоненте
+    size_t source = 0;
+    for (size_t u = 0; u < n; u++)
+        if (g.getNeibs(u).size () > g.getNeibs(source).size ())
+            source = u;
+
+    std::vector <char> reached (n);
+    auto reachedEdges = [&] {
+        size_t edges = g.getNeibs(source).size ();
+        for (size_t u = 0; u < n; u++)
+            if (reached[u]) edges += g.getNeibs(u).size ();
+        return edges;
+    };
+    auto allArcs = [&] { return arcs; };
+    auto allEdges = [&] { return weighted.edgeCount (); };
+
+    std::vector <Algorithm> algorithms =
+    {
+        {"bfs", [&] { std::fill (reached.begin (), reached.end (), 0); Visit visit { &reached }; bfs (g, source, visit); }, reachedEdges},
+        {"pbfs", [&] { std::fill (reached.begin (), reached.end (), 0); Visit visit { &reached }; parallel.run (source, visit); }, reachedEdges},
+        {"dfs", [&] {
+            std::vector <bool> seen (n, false);
+            Enter enter { &seen };
+            Exit exit;
+            for (size_t u = 0; u < n; u++)
+                if (!seen[u]) dfs (g, u, enter, exit);
+        }, allArcs},
+        {"scc", [&] { sink += tarjanSCC (g).count; }, allArcs},
+        {"topo", [&] { sink += topoLevels (g, &pool).levels (); }, allArcs},
+        {"prim", [&] { sink += totalWeight (getMST (weighted)); }, allEdges},
+        {"kruskal", [&] { sink += totalWeight (getMSTKruskal (weighted)); }, allEdges},
+        {"boruvka", [&] { sink += totalWeight (getMSTBoruvka (weighted)); }, allEdges},
+    };
+
+    for (auto &algorithm: algorithms)
+    {
+        if (!wanted (options, algorithm.name))
+            continue;
+
+        for (unsigned run = 0; run < options.repeats; run++)
+        {
+            uint64_t values[4];
+            resetPeakRss ();
+            counters.start ();
+            auto start = std::chrono::steady_clock::now ();
+
+            algorithm.run ();
+
+            double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+            counters.stop (values);
+            report (options, workload, algorithm.name, run, seconds, algorithm.edgesTouched (),
+                    peakRssKb (), counters.available (), values);
+        }
+    }
+
+    return sink == (size_t)-1; // не даём компилятору выбросить результаты
+}
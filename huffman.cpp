@@ -1,81 +1,271 @@
 /*
  * Демонстрация алгоритма кодирования Хаффмана
+ *
+ *   huffman                 — канонические коды для "abrashvabracadabra"
+ *   huffman fuzz [rounds]   — сжатие и распаковка случайных данных, сверка с исходными
+ *   huffman bench [MB]      — скорость сжатия и распаковки
+ *   huffman compress in out [threads] [blockKB]
+ *   huffman decompress in out [threads]
+ *                           — потоковое сжатие файла независимыми блоками, по блоку на поток
  */
 
 
-#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
-#include <queue>
 #include <vector>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include "Huffman.hpp"
 
-using std::vector, std::string, std::priority_queue;
+using std::vector, std::string;
 
-struct Node
+// Коды символов строки s (пустая строка — символ не встречается)
+vector <string> huf (const string &s)
 {
-    int sym = -1;
-    size_t freq = 0;
-    Node *left = nullptr, *right = nullptr;
-};
+    vector <uint8_t> lengths = codeLengths (byteFrequencies ((const uint8_t *) s.data (), s.size ()));
+    vector <uint16_t> codes = canonicalCodes (lengths);
+
+    // на практике не хранятся сами коды - хранятся длины; коды восстанавливаются канонически
+    vector <string> ret (ALPHABET_SIZE);
+    for (unsigned sym = 0; sym < ALPHABET_SIZE; sym++)
+        for (unsigned bit = 0; bit < lengths[sym]; bit++)
+            ret[sym] += (codes[sym] >> bit) & 1 ? '1' : '0';
+
+    return ret;
+}
 
-struct pq_less 
+// Случайные данные: равномерные, с геометрическим распределением, с длинными повторами
+vector <uint8_t> randomData (std::mt19937_64 &random, size_t size, int kind)
 {
-    bool operator() (const Node *lhs, const Node *rhs)
+    vector <uint8_t> data (size);
+    std::geometric_distribution <int> geometric (kind == 1 ? 0.3 : 0.02);
+
+    for (size_t i = 0; i < size; i++)
     {
-        return lhs->freq > rhs->freq;
+        switch (kind)
+        {
+            case 0:  data[i] = (uint8_t) random ();                      break;
+            case 1:
+            case 2:  data[i] = (uint8_t) std::min (geometric (random), 255); break;
+            default: data[i] = (uint8_t) (random () % 1000 ? (i ? data[i - 1] : 0) : random ()); break;
+        }
     }
-};
+    return data;
+}
 
-void walk (const Node *node, const string &s)
+int fuzz (int rounds)
 {
-    if (node->left  != nullptr) walk (node->left , s + "0");
-    if (node->right != nullptr) walk (node->right, s + "1");
-    if (node->sym >= 0)
-        printf ("%c: \'%s\'\n", node->sym, s.c_str ());
+    std::mt19937_64 random (1);
+
+    for (int round = 0; round < rounds; round++)
+    {
+        size_t size = round % 10 == 0 ? random () % 200000 : random () % 2000;
+        vector <uint8_t> data = randomData (random, size, round % 4);
+
+        vector <uint8_t> packed = huffmanCompress (data.data (), data.size ()), unpacked;
+        if (!huffmanDecompress (packed.data (), packed.size (), unpacked) || unpacked != data)
+        {
+            printf ("round %d: round trip failed on %zu bytes\n", round, size);
+            return 1;
+        }
+
+        // повреждённый поток не должен приводить к выходу за границы
+        if (!packed.empty ())
+        {
+            packed[random () % packed.size ()] ^= (uint8_t) (1 + random () % 255);
+            huffmanDecompress (packed.data (), packed.size (), unpacked);
+            packed.resize (random () % packed.size ());
+            huffmanDecompress (packed.data (), packed.size (), unpacked);
+        }
+    }
+
+    printf ("%d rounds passed\n", rounds);
+    return 0;
 }
 
-vector <string> huf (const string &s)
+void benchmark (size_t megabytes)
+{
+    std::mt19937_64 random (1);
+    const char *NAMES[] = {"uniform", "geometric(0.3)", "geometric(0.02)", "runs"};
+
+    for (int kind = 0; kind < 4; kind++)
+    {
+        vector <uint8_t> data = randomData (random, megabytes << 20, kind), packed, unpacked;
+
+        auto start = std::chrono::steady_clock::now ();
+        packed = huffmanCompress (data.data (), data.size ());
+        auto middle = std::chrono::steady_clock::now ();
+        bool ok = huffmanDecompress (packed.data (), packed.size (), unpacked) && unpacked == data;
+        auto end = std::chrono::steady_clock::now ();
+
+        double encode = std::chrono::duration <double> (middle - start).count ();
+        double decode = std::chrono::duration <double> (end - middle).count ();
+        printf ("%-16s ratio %.3f, encode %.0f MB/s, decode %.0f MB/s%s\n", NAMES[kind],
+                (double) packed.size () / data.size (), megabytes / encode, megabytes / decode, ok ? "" : "  ROUND TRIP FAILED");
+    }
+
+    // длины кодов для больших алфавитов (16-битные символы, токены) с частотами по Ципфу
+    for (unsigned bits: {16u, 20u})
+    {
+        vector <uint64_t> freq (1u << bits);
+        for (size_t sym = 0; sym < freq.size (); sym++)
+            freq[sym] = 1 + (uint64_t) (1e9 / (sym + 1)) + random () % 8;
+
+        auto start = std::chrono::steady_clock::now ();
+        vector <uint8_t> lengths = codeLengths (freq, 24);
+        double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+
+        printf ("code lengths for 2^%u symbols: %.1f ms, longest %u\n", bits, seconds * 1e3,
+                (unsigned) *std::max_element (lengths.begin (), lengths.end ()));
+    }
+}
+
+const char FILE_MAGIC[8] = {'D', 'A', 'K', 'H', 'U', 'F', 'F', '1'};
+
+// func (i) для i из [0, count); блоки разного веса, поэтому раздаются по одному
+template <typename Func>
+void parallelFor (size_t count, unsigned threads, Func func)
+{
+    std::atomic <size_t> next = 0;
+    auto worker = [&] {
+        for (size_t i; (i = next++) < count;)
+            func (i);
+    };
+
+    std::vector <std::thread> workers;
+    for (unsigned t = 1; t < std::min <size_t> (threads, count); t++)
+        workers.emplace_back (worker);
+    worker ();
+    for (auto &w: workers)
+        w.join ();
+}
+
+// Файл читается пачками по BATCH блоков на поток, блоки пачки сжимаются параллельно
+bool compressFile (FILE *in, FILE *out, unsigned threads, size_t blockSize)
 {
-    vector <string> ret;
-    vector <int> freq (256);
+    const size_t BATCH = 4;
+    size_t blocks = threads * BATCH;
+    vector <uint8_t> input (blocks * blockSize);
+    vector <vector <uint8_t>> packed (blocks);
 
-    for (auto c: s)
+    if (fwrite (FILE_MAGIC, 1, sizeof (FILE_MAGIC), out) != sizeof (FILE_MAGIC))
+        return false;
+
+    size_t read;
+    while ((read = fread (input.data (), 1, input.size (), in)) > 0)
     {
-        freq [c & 0xFF] ++;
+        size_t count = (read + blockSize - 1) / blockSize;
+        parallelFor (count, threads, [&] (size_t b) {
+            packed[b].clear ();
+            compressBlock (input.data () + b * blockSize, std::min (blockSize, read - b * blockSize), packed[b]);
+        });
+
+        for (size_t b = 0; b < count; b++)
+            if (fwrite (packed[b].data (), 1, packed[b].size (), out) != packed[b].size ())
+                return false;
     }
 
-    vector <Node*> nodes;
-    priority_queue <Node*, vector <Node*>, pq_less> pq;
+    uint8_t end[BLOCK_HEADER_SIZE];
+    writeBlockHeader ({0, 0, BLOCK_STORED}, end);
+    return !ferror (in) && fwrite (end, 1, BLOCK_HEADER_SIZE, out) == BLOCK_HEADER_SIZE;
+}
+
+bool decompressFile (FILE *in, FILE *out, unsigned threads)
+{
+    const size_t BATCH = 4;
+    char magic[sizeof (FILE_MAGIC)];
+    if (fread (magic, 1, sizeof (magic), in) != sizeof (magic) || memcmp (magic, FILE_MAGIC, sizeof (magic)))
+        return false;
+
+    size_t blocks = threads * BATCH;
+    vector <BlockHeader> headers (blocks);
+    vector <vector <uint8_t>> packed (blocks), unpacked (blocks);
 
-    for (int sym = 0; sym < 256; sym++)
+    for (bool finished = false; !finished;)
     {
-        if (freq[sym] > 0)
+        size_t count = 0;
+        while (count < blocks)
         {
-            Node *n = new Node ();
-            n->sym = sym;
-            n->freq = freq [sym];
-            pq.push (n);
+            uint8_t raw[BLOCK_HEADER_SIZE];
+            if (fread (raw, 1, BLOCK_HEADER_SIZE, in) != BLOCK_HEADER_SIZE || !readBlockHeader (raw, headers[count]))
+                return false;
+            if (headers[count].rawSize == 0)
+            {
+                finished = true;
+                break;
+            }
+
+            packed[count].resize (headers[count].packedSize);
+            if (fread (packed[count].data (), 1, packed[count].size (), in) != packed[count].size ())
+                return false;
+            count++;
         }
+
+        std::atomic <bool> ok = true;
+        parallelFor (count, threads, [&] (size_t b) {
+            unpacked[b].resize (headers[b].rawSize);
+            if (!decompressBlock (headers[b], packed[b].data (), unpacked[b].data ()))
+                ok = false;
+        });
+        if (!ok)
+            return false;
+
+        for (size_t b = 0; b < count; b++)
+            if (fwrite (unpacked[b].data (), 1, unpacked[b].size (), out) != unpacked[b].size ())
+                return false;
     }
 
-    while (pq.size () > 1)
+    return true;
+}
+
+int main (int argc, char **argv)
+{
+    if (argc > 3 && (!strcmp (argv[1], "compress") || !strcmp (argv[1], "decompress")))
     {
-        auto el1 = pq.top (); pq.pop ();
-        auto el2 = pq.top (); pq.pop ();
-        auto par = new Node {-1, el1->freq + el2->freq, el1, el2};
-        pq.push (par);
-        // на практике не хранятся сами коды - хранятся длины
-    }
+        bool compress = !strcmp (argv[1], "compress");
+        unsigned threads = argc > 4 ? atoi (argv[4]) : std::thread::hardware_concurrency ();
+        size_t blockSize = argc > 5 ? atol (argv[5]) << 10 : (size_t) 1 << 20;
+        threads = std::max (threads, 1u);
+        blockSize = std::clamp <size_t> (blockSize, 1, MAX_BLOCK_SIZE);
 
-    auto root = pq.top (); pq.pop ();
-    
-    walk (root, "");
+        FILE *in = fopen (argv[2], "rb"), *out = fopen (argv[3], "wb");
+        if (!in || !out)
+        {
+            perror ("huffman");
+            return 1;
+        }
 
-    return ret;
-}
+        auto start = std::chrono::steady_clock::now ();
+        bool ok = compress ? compressFile (in, out, threads, blockSize) : decompressFile (in, out, threads);
+        double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
 
+        long inSize = ftell (in), outSize = ftell (out);
+        fclose (in);
+        if (fclose (out) != 0)
+            ok = false;
+
+        if (!ok)
+        {
+            fprintf (stderr, "huffman: %s failed\n", argv[1]);
+            return 1;
+        }
+        printf ("%ld -> %ld bytes, %.0f MB/s\n", inSize, outSize, (compress ? inSize : outSize) / seconds / (1 << 20));
+        return 0;
+    }
+
+    if (argc > 1 && !strcmp (argv[1], "fuzz"))
+        return fuzz (argc > 2 ? atoi (argv[2]) : 2000);
+
+    if (argc > 1 && !strcmp (argv[1], "bench"))
+    {
+        benchmark (argc > 2 ? atol (argv[2]) : 64);
+        return 0;
+    }
 
-int main ()
-{
     auto res = huf ("abrashvabracadabra");
 
     for (size_t i = 0; i < res.size(); i++)
@@ -1,240 +1,343 @@
-#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <cmath>
+#include <vector>
+#include <random>
+#include <chrono>
 #include <algorithm>
-#include <cstdlib> // for malloc
-#include <cstring>
-#include <cassert>
-#include <utility> // for std::pair
+#include <thread>
+#include "ClosestPair.hpp"
+#include "SpatialIndex.hpp"
 
-struct Point
+std::vector <Point> readPoints ()
 {
-    double x, y;
-};
+    int n = 0;
+    if (scanf ("%d", &n) != 1)
+        return {};
+
+    std::vector <Point> points (n);
+    for (int i = 0; i < n; i++)
+        scanf ("%lf %lf", &(points[i].x), &(points[i].y));
+    return points;
+}
 
-inline bool isZero (double d)
+void printPair (const ClosestPair &best, const std::vector <Point> &points)
 {
-    const double EPS = 1e-15;
-    return d < EPS && d > -EPS;
+    std::pair <int, int> closestPair = {best.first, best.second};
+    printf ("%.10lf %d %d\n", sqrt (calcDistanceSqr (closestPair, points.data ())), closestPair.first + 1, closestPair.second + 1);
 }
 
-namespace dak
+// Равномерные точки в квадрате или clusters гауссовых облаков
+std::vector <Point> randomPoints (int n, int clusters, uint64_t seed)
 {
-    template <class ParamT, class KeyT, class Higher, class... Args>
-    const ParamT* binsearch (const ParamT *first, const ParamT *last, const KeyT &key, Args& ... args)
-    {
-        const ParamT *start = first, *end = last - 1, *mid;
-        int comp = 666;
+    std::mt19937_64 random (seed);
+    std::uniform_real_distribution <double> uniform (0, 1e6);
+    std::normal_distribution <double> normal (0, 1e3);
 
-        Higher fool;
+    std::vector <Point> centers (clusters);
+    for (auto &c: centers)
+        c = {uniform (random), uniform (random)};
 
-        while (start <= end)
+    std::vector <Point> points (n);
+    for (auto &p: points)
+    {
+        if (clusters == 0)
+            p = {uniform (random), uniform (random)};
+        else
         {
-            mid = start + (end - start) / 2;
-
-            comp = fool (mid, key, args...);
-
-            if (comp) 
-                end = mid - 1;
-            else 
-                start = mid + 1;
+            const Point &c = centers[random () % clusters];
+            p = {c.x + normal (random), c.y + normal (random)};
         }
-
-        return comp ? mid - 1 : mid;
     }
+    return points;
 }
 
-struct X_Higher
+template <typename Func>
+double secondsOf (Func func)
 {
-    int operator() (const int *&index, const double &key, const Point *&points)
-    {
-        return points [*index].x > key;
-    }
-};
+    auto start = std::chrono::steady_clock::now ();
+    func ();
+    return std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+}
 
-struct Y_Higher
+// Ближайшая пара: разделяй и властвуй (1 и threads потоков) против сетки; k-d дерево: построение,
+// пакетные k-NN и запросы в радиусе
+void benchmarkSpatial (int n, unsigned threads)
 {
-    int operator() (const int *index, const double key, const Point *points)
+    const int K = 8;
+    const int QUERIES = std::max (1, n / 10);
+
+    for (int clusters: {0, 16})
     {
-        return points [*index].y > key;
+        // запросы — из того же распределения, что и точки
+        std::vector <Point> points = randomPoints (n + QUERIES, clusters, 1);
+        std::vector <Point> queries (points.begin () + n, points.end ());
+        points.resize (n);
+
+        ClosestPair serial, parallel, soa, single, grid;
+        double serialTime = secondsOf ([&] { serial = findClosestPair (points.data (), n, 1); });
+        double parallelTime = secondsOf ([&] { parallel = findClosestPair (points.data (), n, threads); });
+        double soaTime = secondsOf ([&] { soa = findClosestPairSoA (points.data (), n, 1); });
+        double floatTime = secondsOf ([&] { single = findClosestPairSoA <float> (points.data (), n, 1); });
+        double gridTime = secondsOf ([&] { grid = findClosestPairGrid (points.data (), n); });
+
+        bool same = serial.first == parallel.first && serial.second == parallel.second &&
+                    serial.first == soa.first && serial.second == soa.second &&
+                    serial.first == grid.first && serial.second == grid.second;
+
+        printf ("%s, n = %d\n", clusters ? "clustered" : "uniform", n);
+        printf ("  closest pair: d&c %.3f s, d&c x%u %.3f s, d&c soa %.3f s, d&c soa float %.3f s, grid %.3f s%s\n",
+                serialTime, threads, parallelTime, soaTime, floatTime, gridTime, same ? "" : "  MISMATCH");
+        if (single.first != serial.first || single.second != serial.second)
+            printf ("  float: %d %d at %.10lf (double: %d %d)\n", single.first + 1, single.second + 1,
+                    sqrt (calcDistanceSqr ({single.first, single.second}, points.data ())), serial.first + 1, serial.second + 1);
+
+        KdTree *tree = nullptr;
+        double buildTime = secondsOf ([&] { tree = new KdTree (points.data (), n); });
+
+        std::vector <int> neighbours;
+        double knnTime = secondsOf ([&] { neighbours = tree->nearestBatch (queries.data (), QUERIES, K, threads); });
+
+        // радиус, в который в среднем попадает около K точек
+        double r = std::sqrt (calcDistanceSqr (queries[0], points[neighbours[K - 1]]));
+        size_t found = 0;
+        double radiusTime = secondsOf ([&] {
+            for (auto &row: tree->withinRadiusBatch (queries.data (), QUERIES, r, threads))
+                found += row.size ();
+        });
+
+        std::vector <std::pair <int, int>> pairs;
+        double pairsTime = secondsOf ([&] { pairs = pairsWithinRadius (points.data (), n, r / 4); });
+
+        printf ("  k-d tree: build %.3f s, %d x %d-NN %.3f s, %d radius queries %.3f s (%zu hits)\n",
+                buildTime, QUERIES, K, knnTime, QUERIES, radiusTime, found);
+        printf ("  grid: all pairs within %.3g — %zu pairs, %.3f s\n", r / 4, pairs.size (), pairsTime);
+
+        delete tree;
     }
-};
-
-inline double calcDistanceSqr (const std::pair <int, int> &pair, const Point *points)
-{
-    return 
-      std::pow (points[pair.first].x - points[pair.second].x, 2)
-    + std::pow (points[pair.first].y - points[pair.second].y, 2);
 }
 
-std::pair <int, int> findClosestPair (const int *range, const Point *points, int start, int end)
+// Случайные входы для проверки: равномерные, целочисленная решётка с ничьими, повторы, облака
+std::vector <Point> testPoints (std::mt19937_64 &random, int n, int kind)
 {
-    if (end - start < 4)
-    {
-        std::pair <int, int> result = { range[start], range[start + 1] };
-        double min_distance_sqr = INFINITY;
-
-        for (int i = start; i < end; i++)
-        for (int j = i + 1; j < end; j++)
-            {
-                double dist_sqr = calcDistanceSqr ({range[i], range[j]}, points);
-                if (isZero (dist_sqr - min_distance_sqr))
-                {
-                    if (range[i] <= result.first && range[j] <= result.second
-                    || range[j] <= result.first && range[i] <= result.second)
-                    {
-                        min_distance_sqr = dist_sqr;
-                        result = {range[i], range[j]};
-                        result = {range[i], range[j]};
-                    }
-                }
-                else if (dist_sqr < min_distance_sqr)
-                {
-                    min_distance_sqr = dist_sqr;
-                    result = {range[i], range[j]};
-                    result = {range[i], range[j]};
-                }
-            }
-        
-        return result;
-
-    }
-
-
-    int pivot = (start + end) / 2;
-
-    std::pair <int, int> result_1 = findClosestPair (range, points, start, pivot);
-    double distance_sqr_1 = calcDistanceSqr (result_1, points);
-
-    std::pair <int, int> result_2 = findClosestPair (range, points, pivot, end);
-    double distance_sqr_2 = calcDistanceSqr (result_2, points);
-
-    double min_distance_sqr;
-    std::pair <int, int> result;
-
-    if (isZero (distance_sqr_2 - distance_sqr_1))
+    std::vector <Point> points (n);
+    for (int i = 0; i < n; i++)
     {
-        if (result_1.first <= result_2.first && result_1.second <= result_2.second
-         || result_1.first <= result_2.second && result_1.second <= result_2.first)
-        {
-            result = result_1;
-            min_distance_sqr = distance_sqr_1;
-        }
-        else
+        switch (kind)
         {
-            result = result_2;
-            min_distance_sqr = distance_sqr_2;
+            case 0:  points[i] = {random () / 1e15, random () / 1e15};                        break;
+            case 1:  points[i] = {(double) (random () % 30), (double) (random () % 30)};      break;
+            case 2:  points[i] = i > 0 && random () % 4 == 0 ? points[random () % i]
+                                                             : Point {(double) (random () % 1000), (double) (random () % 1000)};
+                     break;
+            default: points = randomPoints (n, 3, random ()); return points;
         }
     }
+    return points;
+}
 
-    else if (distance_sqr_1 < distance_sqr_2)
-    {
-        result = result_1;
-        min_distance_sqr = distance_sqr_1;
-    }
-
-    else
-    {
-        result = result_2;
-        min_distance_sqr = distance_sqr_2;
-    }
-
-
-    double min_distance = sqrt (min_distance_sqr);
+// Ближайшая пара в координатах CoordT полным перебором, независимо от ClosestPair::update:
+// сначала минимум расстояния, затем лексикографически первая пара на нём (с точностью isZero)
+template <typename CoordT>
+ClosestPair bruteClosestPair (const std::vector <Point> &points)
+{
+    int n = (int) points.size ();
+    auto distanceSqr = [&] (int i, int j) -> double {
+        CoordT dx = (CoordT) points[j].x - (CoordT) points[i].x, dy = (CoordT) points[j].y - (CoordT) points[i].y;
+        return dx * dx + dy * dy;
+    };
 
-    // Слияние: нужно найти \a и \b, такие что на [\a, \pivot - 1] и [\pivot, \b]
-    // нужно сравнить все пары, отстоящие по y не более чем на \min_distance
+    double minimum = INFINITY;
+    for (int i = 0; i < n; i++)
+    for (int j = i + 1; j < n; j++)
+        minimum = std::min (minimum, distanceSqr (i, j));
 
-    const int *a = dak::binsearch <const int, double, X_Higher, const Point *> (range + start, range + pivot, points[range[pivot]].x - min_distance, points);
-    const int *b = dak::binsearch <const int, double, X_Higher, const Point *> (range + pivot, range + end  , points[range[pivot]].x + min_distance, points);
+    for (int i = 0; i < n; i++)
+    for (int j = i + 1; j < n; j++)
+        if (isZero (distanceSqr (i, j) - minimum))
+            return {i, j, distanceSqr (i, j)};
+    return {};
+}
 
-    if (a < range + start) a = range + start;
-    if (b < range + pivot) return result; //!
+// Все движки ближайшей пары, k-d дерево и пары в радиусе против перебора за O(n^2);
+// раз в 20 раундов — большой вход, где рекурсия уходит в потоки: там движки сверяются между собой
+int test (int rounds)
+{
+    std::mt19937_64 random (1);
 
-    const int leftSize = (range + pivot) - a;
-    const int rightSize = (b + 1) - (range + pivot);
-    int leftPointsToCompare [leftSize];
-    int rightPointsToCompare [rightSize];
-    std::memcpy (leftPointsToCompare, a, leftSize * sizeof (int));
-    std::memcpy (rightPointsToCompare, range + pivot, rightSize * sizeof (int));
+    auto samePair = [] (const ClosestPair &lhs, const ClosestPair &rhs) {
+        return lhs.first == rhs.first && lhs.second == rhs.second;
+    };
 
-    std::sort (leftPointsToCompare, leftPointsToCompare + leftSize,
-    [points](const int &lhs, const int &rhs) -> bool { return points[lhs].y < points[rhs].y; });
+    for (int round = 0; round < rounds; round++)
+    {
+        int kind = round % 4;
 
-    std::sort (rightPointsToCompare, rightPointsToCompare + rightSize,
-    [points](const int &lhs, const int &rhs) -> bool { return points[lhs].y < points[rhs].y; });
+        if (round % 20 == 19)
+        {
+            int n = 2 * SERIAL_CUTOFF + (int) (random () % SERIAL_CUTOFF);
+            std::vector <Point> points = testPoints (random, n, kind);
+            ClosestPair serial = findClosestPair (points.data (), n, 1);
+            for (unsigned threads: {3u, 8u})
+                if (!samePair (serial, findClosestPair (points.data (), n, threads))
+                 || !samePair (serial, findClosestPairSoA (points.data (), n, threads)))
+                {
+                    printf ("round %d: %u threads disagree with 1 thread on %d points\n", round, threads, n);
+                    return 1;
+                }
+            if (!samePair (serial, findClosestPairGrid (points.data (), n, random ())))
+            {
+                printf ("round %d: grid disagrees with d&c on %d points\n", round, n);
+                return 1;
+            }
+            continue;
+        }
 
-    for (int *it = leftPointsToCompare; it < leftPointsToCompare + leftSize; it++)
-    {
-        const int *lowest = 
-        dak::binsearch 
-        <const int, double, Y_Higher, const Point *> 
-        (rightPointsToCompare, rightPointsToCompare + rightSize, points[*it].y - min_distance, points);
+        int n = 2 + (int) (random () % (round % 10 == 0 ? 1500 : 200));
+        std::vector <Point> points = testPoints (random, n, kind);
 
-        const int *highest = 
-        dak::binsearch 
-        <const int, double, Y_Higher, const Point *> 
-        (rightPointsToCompare, rightPointsToCompare + rightSize, points[*it].y + min_distance, points)
-        + 1;
+        ClosestPair expected = bruteClosestPair <double> (points);
+        ClosestPair expectedFloat = bruteClosestPair <float> (points);
+        struct { const char *name; ClosestPair got, want; } engines[] =
+        {
+            {"d&c",           findClosestPair (points.data (), n, 1),               expected},
+            {"d&c x3",        findClosestPair (points.data (), n, 3),               expected},
+            {"d&c soa",       findClosestPairSoA (points.data (), n, 1),            expected},
+            {"d&c soa float", findClosestPairSoA <float> (points.data (), n, 1),    expectedFloat},
+            {"grid",          findClosestPairGrid (points.data (), n, random ()),   expected},
+        };
+        for (auto &engine: engines)
+            if (!samePair (engine.got, engine.want))
+            {
+                printf ("round %d: %s gives %d %d, expected %d %d (%d points)\n", round, engine.name,
+                        engine.got.first + 1, engine.got.second + 1, engine.want.first + 1, engine.want.second + 1, n);
+                return 1;
+            }
 
+        // радиус — расстояние между случайными точками, чтобы попадать точно на границу
+        std::vector <Point> queries = testPoints (random, 1 + (int) (random () % 20), kind);
+        queries.push_back (points[random () % n]);
+        int count = (int) queries.size ();
+        int k = 1 + (int) (random () % 10);
+        double r = std::sqrt (calcDistanceSqr (points[random () % n], points[random () % n]));
+        double rSqr = r * r;
 
-        if (lowest < rightPointsToCompare)
-            lowest = rightPointsToCompare;
+        KdTree tree (points.data (), n);
+        std::vector <int> neighbours = tree.nearestBatch (queries.data (), count, k, 3);
+        std::vector <std::vector <int>> inRadius = tree.withinRadiusBatch (queries.data (), count, r, 3);
 
-        for (const int *itt = lowest; itt < highest; itt++)
+        for (int q = 0; q < count; q++)
         {
-            double dist_sqr = calcDistanceSqr ({*it, *itt}, points);
-            if (isZero (dist_sqr - min_distance_sqr))
+            std::vector <std::pair <double, int>> byDistance (n);
+            std::vector <int> wantRadius;
+            for (int i = 0; i < n; i++)
             {
-                if (*it <= result.first && *itt <= result.second
-                || *itt <= result.first && *it <= result.second)
+                byDistance[i] = {calcDistanceSqr (queries[q], points[i]), i};
+                if (byDistance[i].first <= rSqr)
+                    wantRadius.push_back (i);
+            }
+            std::sort (byDistance.begin (), byDistance.end ());
+
+            for (int j = 0; j < k; j++)
+            {
+                int want = j < n ? byDistance[j].second : -1;
+                if (neighbours[(size_t) q * k + j] != want)
                 {
-                    min_distance_sqr = dist_sqr;
-                    result = { *it, *itt };
-                    result = { *it, *itt };
+                    printf ("round %d: query %d, neighbour %d of %d is %d, expected %d\n",
+                            round, q, j + 1, k, neighbours[(size_t) q * k + j] + 1, want + 1);
+                    return 1;
                 }
             }
-            if (dist_sqr < min_distance_sqr)
-            {   
-                min_distance_sqr = dist_sqr;
-                min_distance = sqrt (min_distance_sqr);
-                result = { *it, *itt };
-                result = { *it, *itt };
+            if (inRadius[q] != wantRadius)
+            {
+                printf ("round %d: query %d, %zu points within %.10g, expected %zu\n",
+                        round, q, inRadius[q].size (), r, wantRadius.size ());
+                return 1;
             }
         }
-    }
 
-    return result;
+        std::vector <std::pair <int, int>> wantPairs;
+        for (int i = 0; i < n; i++)
+        for (int j = i + 1; j < n; j++)
+            if (calcDistanceSqr (points[i], points[j]) <= rSqr)
+                wantPairs.push_back ({i, j});
+        if (pairsWithinRadius (points.data (), n, r) != wantPairs)
+        {
+            printf ("round %d: pairs within %.10g differ from brute force (%d points)\n", round, r, n);
+            return 1;
+        }
+    }
 
+    printf ("%d rounds passed\n", rounds);
+    return 0;
 }
 
-int main ()
+// min-distance [threads] < points          — ближайшая пара, разделяй и властвуй
+// min-distance soa [threads] < points      — то же движком на структуре массивов
+// min-distance float [threads] < points    — движок на структуре массивов в координатах float
+// min-distance grid < points               — ближайшая пара, рандомизированная сетка
+// min-distance knn k < points queries      — k ближайших точек для каждого запроса
+// min-distance bench [n] [threads]
+// min-distance test [rounds]               — сверка всех движков с полным перебором
+int main (int argc, char **argv)
 {
-    int n;
-    scanf ("%d", &n);
+    unsigned threads = std::thread::hardware_concurrency ();
 
-    char *buffer = (char *) malloc (n * sizeof (Point) + n * sizeof (int));
+    if (argc > 1 && !strcmp (argv[1], "test"))
+        return test (argc > 2 ? atoi (argv[2]) : 1000);
 
-    Point *points = (Point *) buffer;
-    int *range = (int *)(buffer + n * sizeof (Point));
+    if (argc > 1 && !strcmp (argv[1], "bench"))
+    {
+        int n = argc > 2 ? atoi (argv[2]) : 2000000;
+        if (argc > 3) threads = atoi (argv[3]);
+        benchmarkSpatial (n, threads);
+        return 0;
+    }
 
-    for (int i = 0; i < n; i++)
+    if (argc > 1 && !strcmp (argv[1], "soa"))
     {
-        scanf ("%lf %lf", &(points[i].x), &(points[i].y));
+        if (argc > 2) threads = atoi (argv[2]);
+        std::vector <Point> points = readPoints ();
+        printPair (findClosestPairSoA (points.data (), (int) points.size (), threads), points);
+        return 0;
+    }
 
-        range[i] = i;
+    if (argc > 1 && !strcmp (argv[1], "float"))
+    {
+        if (argc > 2) threads = atoi (argv[2]);
+        std::vector <Point> points = readPoints ();
+        printPair (findClosestPairSoA <float> (points.data (), (int) points.size (), threads), points);
+        return 0;
     }
 
-    std::sort (range, range + n, [points](const int &lhs, const int &rhs) -> bool { return points[lhs].x < points[rhs].x; });
+    if (argc > 1 && !strcmp (argv[1], "grid"))
+    {
+        std::vector <Point> points = readPoints ();
+        printPair (findClosestPairGrid (points.data (), (int) points.size ()), points);
+        return 0;
+    }
 
-    /*printf ("Range: ");
-    for (int i = 0; i < n; i++)
-        printf ("%d ", range[i]);
-    printf ("\n");*/
+    if (argc > 2 && !strcmp (argv[1], "knn"))
+    {
+        int k = atoi (argv[2]);
+        std::vector <Point> points = readPoints ();
+        std::vector <Point> queries = readPoints ();
 
-    std::pair <int, int> closestPair = findClosestPair (range, points, 0, n);
-    if (closestPair.first > closestPair.second) std::swap (closestPair.first, closestPair.second);
-    printf ("%.10lf %d %d\n", sqrt (calcDistanceSqr (closestPair, points)), closestPair.first + 1, closestPair.second + 1);
+        KdTree tree (points.data (), (int) points.size ());
+        std::vector <int> neighbours = tree.nearestBatch (queries.data (), (int) queries.size (), k, threads);
+        for (size_t i = 0; i < queries.size (); i++)
+        {
+            for (int j = 0; j < k && neighbours[i * k + j] != -1; j++)
+                printf ("%d ", neighbours[i * k + j] + 1);
+            printf ("\n");
+        }
+        return 0;
+    }
 
+    if (argc > 1)
+        threads = atoi (argv[1]);
 
-    free (buffer);
+    std::vector <Point> points = readPoints ();
+    printPair (findClosestPair (points.data (), (int) points.size (), threads), points);
 }
@@ -0,0 +1,127 @@
+/*
+ * Микробенчмарк модульной арифметики из ModularArithmetic.h против прежних
+ * рекурсивных powMod/divideMod из combination.c.
+ *
+ *   modular-benchmark [count]
+ *
+ * На каждый модуль: count возведений в степень p - 2 и обращение count чисел
+ * (по одному через divideMod и пачкой приёмом Монтгомери). Прежние функции считают
+ * base * consol в 64 битах и для модулей больше 2^32 не запускаются — там они ошибаются.
+ * Последний столбец — контрольная сумма: у всех вариантов одного модуля она должна совпадать.
+ */
+
+/* clock_gettime и CLOCK_MONOTONIC — POSIX, в строгих -std=c99/c11/c17 без этого не объявлены */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ModularArithmetic.h"
+
+/*
+ * прежний powMod из combination.c
+ */
+static uint64_t powModRecursive (uint64_t base, uint64_t power, uint64_t mod)
+{
+    if (power == 0) return 1;
+    uint64_t consol = powModRecursive (base, power / 2, mod);
+    if (power % 2 == 1) return ((base * consol) % mod) * consol % mod;
+    return consol * consol % mod;
+}
+
+/*
+ * прежний divideMod из combination.c
+ */
+static uint64_t divideModRecursive (uint64_t numerator, uint64_t denominator, uint64_t modulo)
+{
+    return numerator * powModRecursive (denominator, modulo - 2, modulo) % modulo;
+}
+
+static double now (void)
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report (uint64_t mod, const char *name, double seconds, size_t count, uint64_t checksum)
+{
+    printf ("%20llu %22s %10.3f %10.1f %20llu\n", (unsigned long long) mod, name, seconds,
+            seconds * 1e9 / count, (unsigned long long) checksum);
+}
+
+static void benchmark (uint64_t mod, size_t count)
+{
+    uint64_t *values = malloc (count * sizeof (uint64_t));
+    uint64_t *scratch = malloc (count * sizeof (uint64_t));
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        values[i] = 1 + state % (mod - 1);
+    }
+
+    Montgomery m = montgomeryInit (mod);
+    double start;
+    uint64_t checksum;
+
+    if (mod < (1ULL << 32))
+    {
+        start = now ();
+        checksum = 0;
+        for (size_t i = 0; i < count; i++) checksum ^= powModRecursive (values[i], mod - 2, mod);
+        report (mod, "pow recursive", now () - start, count, checksum);
+    }
+
+    start = now ();
+    checksum = 0;
+    for (size_t i = 0; i < count; i++) checksum ^= powMod (values[i], mod - 2, mod);
+    report (mod, "pow 128-bit", now () - start, count, checksum);
+
+    if (mod < (1ULL << 32))
+    {
+        Barrett b = barrettInit (mod);
+        start = now ();
+        checksum = 0;
+        for (size_t i = 0; i < count; i++) checksum ^= barrettPow (&b, values[i], mod - 2);
+        report (mod, "pow barrett", now () - start, count, checksum);
+    }
+
+    start = now ();
+    checksum = 0;
+    for (size_t i = 0; i < count; i++)
+        checksum ^= montgomeryFrom (&m, montgomeryPow (&m, montgomeryTo (&m, values[i]), mod - 2));
+    report (mod, "pow montgomery", now () - start, count, checksum);
+
+    /* обращение: divideMod на каждый элемент против одной пачки */
+    if (mod < (1ULL << 32))
+    {
+        start = now ();
+        checksum = 0;
+        for (size_t i = 0; i < count; i++) checksum ^= divideModRecursive (1, values[i], mod);
+        report (mod, "inverse divideMod", now () - start, count, checksum);
+    }
+
+    start = now ();
+    for (size_t i = 0; i < count; i++) values[i] = montgomeryTo (&m, values[i]);
+    montgomeryBatchInverse (&m, values, scratch, count);
+    checksum = 0;
+    for (size_t i = 0; i < count; i++) checksum ^= montgomeryFrom (&m, values[i]);
+    report (mod, "inverse batch", now () - start, count, checksum);
+
+    free (values);
+    free (scratch);
+}
+
+int main (int argc, char **argv)
+{
+    size_t count = argc > 1 ? strtoull (argv[1], NULL, 10) : 200000;
+
+    printf ("%20s %22s %10s %10s %20s\n", "modulus", "method", "seconds", "ns/op", "checksum");
+    benchmark (998244353ULL, count);
+    benchmark (4294967291ULL, count);
+    benchmark ((1ULL << 61) - 1, count);
+    benchmark (18446744073709551557ULL, count);
+}
@@ -1,91 +1,75 @@
 #include "WeightedGraph.hpp"
-#include <limits>
+#include "CSRGraph.hpp"
+#include "MST.hpp"
+#include "GraphGenerators.hpp"
+#include "GraphSnapshot.hpp"
 #include <cstdio>
+#include <cstring>
+#include <chrono>
 
-// Prime algo
-template <typename WeightT>
-WeightedGraph<WeightT> getMST (const WeightedGraph<WeightT>& g)
+void benchmarkMST ()
 {
-    using edge_t = WeightedGraph<WeightT>::WeightedEdge;
+    const struct { Strategy strategy; const char *name; } STRATEGIES[] =
+    {
+        {Strategy::PRIM, "prim"}, {Strategy::KRUSKAL, "kruskal"}, {Strategy::BORUVKA, "boruvka"}
+    };
 
-    struct oq_compare
+    printf ("%10s %10s %10s %10s %12s\n", "V", "E", "strategy", "seconds", "weight");
+    for (size_t n: {10000, 100000, 1000000})
+    for (size_t degree: {2, 8, 32})
     {
-        bool operator () (const edge_t &lhs, const edge_t &rhs)
+        if (n * degree > 8000000)
+            continue;
+
+        auto edges = erdosRenyiEdges (n, n * degree, 1);
+        CSRGraph<int> g (n, edges);
+
+        for (auto [strategy, name]: STRATEGIES)
         {
-            return lhs.weight > rhs.weight;
+            auto start = std::chrono::steady_clock::now ();
+            auto forest = mst (g, strategy);
+            double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+
+            printf ("%10zu %10zu %10s %10.3f %12lld\n", n, edges.size (), name, seconds, (long long) totalWeight (forest));
         }
-    };
+    }
+}
 
-    std::priority_queue <edge_t, std::vector<edge_t>, oq_compare> qu;
 
-    WeightedGraph<WeightT> mst (g.size ());
-    
-    // Выбираем произвольную вершину (нулевую) и кладём в очередь все инцидентные ей рёбра
+int main (int argc, char **argv)
+{ 
+    if (argc > 1 && strcmp (argv[1], "bench") == 0)
     {
-        size_t u = 0;
-        for (auto [v, weight]: g.getNeibs(u))
-            qu.push ({u, v, weight});
+        benchmarkMST ();
+        return 0;
     }
 
-    // Выбираем самое лёгкое ребро из очереди и добавляем его в MST
-    edge_t light = qu.top (); qu.pop ();
-    mst.insert (light);
-
-    // Выбираем вершину которой инцидентно ребро (не нулевую) и добавляем в очередь все её рёбра
-    size_t vertex = std::max (light.u, light.v);
-    for (auto [newU, newWeight]: g.getNeibs(vertex))
-        if (newU != 0)
-            qu.push ({vertex, newU, newWeight});
-        
-
-    // Пока дерево не покрыло весь граф, ...
-    for (size_t mstEdges = 1, end = g.size () - 1; mstEdges < end;)
+    // import edges.txt graph.bin: текстовый список рёбер "u v weight" -> бинарный снимок
+    if (argc > 3 && strcmp (argv[1], "import") == 0)
     {
-        // Выбираем самое лёгкое ребро из очереди и добавляем его в MST
-        auto [u, v, weight] = qu.top (); qu.pop ();
-        bool uIsNew = mst.getNeibs(u).empty();
-        bool vIsNew = mst.getNeibs(v).empty();
-        mst.insert (u, v, weight);
-        ++mstEdges;
-
-        // Если оно идёт в новую вершину (одна из u, v новая для MST), добавляем все рёбра, смежные с ней, в MST
-        if (uIsNew)
+        EdgeList<int> list = importEdgeList<int> (argv[2]);
+        if (!list.ok || !writeSnapshot (argv[3], CSRGraph<int> (list.vertices, list.edges)))
         {
-            for (auto [newV, newWeight]: g.getNeibs(u))
-                if (mst.getNeibs(newV).empty())
-                    qu.push ({u, newV, newWeight});
-            continue;
+            fprintf (stderr, "cannot convert %s to %s\n", argv[2], argv[3]);
+            return 1;
         }
-        if (vIsNew)
+        printf ("%zu vertices, %zu edges\n", list.vertices, list.edges.size ());
+        return 0;
+    }
+
+    // load graph.bin: MST графа, отображённого из снимка
+    if (argc > 2 && strcmp (argv[1], "load") == 0)
+    {
+        MappedGraph<int> g;
+        if (!g.open (argv[2], true))
         {
-            for (auto [newU, newWeight]: g.getNeibs(v))
-                if (mst.getNeibs(newU).empty())
-                    qu.push ({v, newU, newWeight});
-            continue;
+            fprintf (stderr, "%s: %s\n", argv[2], g.error ());
+            return 1;
         }
-        // если ни одна из вершин u,v в MST в графе не новая, удаляем самое тяжёлое ребро из инцидентных им,
-        // чтобы не было цикла
-        edge_t max_edge { };
-        max_edge.weight = std::numeric_limits<WeightT>::min ();
-
-        for (auto [otherU, otherWeight]: mst.getNeibs(v))
-            if (max_edge.weight < otherWeight)
-                max_edge = {v, otherU, otherWeight};
-        
-        for (auto [otherV, otherWeight]: mst.getNeibs(u))
-            if (max_edge.weight < otherWeight)
-                max_edge = {u, otherV, otherWeight};
-
-        mst.erase (max_edge);
-        --mstEdges;
+        printf ("MST weight %lld\n", (long long) totalWeight (getMSTKruskal (g)));
+        return 0;
     }
 
-    return mst;
-}
-
-
-int main ()
-{ 
     WeightedGraph<int> g (8);
     g.insert (0, 2, 7);
     g.insert (0, 1, 10);
@@ -110,4 +94,3 @@ int main ()
     }
     
 }
-
@@ -16,9 +16,23 @@
  * то есть, отрезка, закрытого на левом и правом концах.
  *
  * Запрос с кодом два тоже содержит два аргумента, первый из которых есть номер элемента массива V, а второй — его новое значение. 
+ *
+ *   segment-tree bench [N] [M] — дерево отрезков против дерева Фенвика на XOR-нагрузке
+ *                                 и против разреженной таблицы на статических запросах минимума
  */
 
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <bit>
+#include <cstring>
+#include <type_traits>
 
 
 template <typename T, typename Oper, typename Neutral>
@@ -124,14 +138,295 @@ struct neutral
 };
 
 
-int main ()
+template <typename T>
+struct sum_tr
+{
+    T operator() (T lhs, T rhs)
+    {
+        return lhs + rhs;
+    }
+};
+
+template <typename T>
+struct min_tr
+{
+    T operator() (T lhs, T rhs)
+    {
+        return lhs < rhs ? lhs : rhs;
+    }
+};
+
+template <typename T>
+struct max_tr
+{
+    T operator() (T lhs, T rhs)
+    {
+        return lhs < rhs ? rhs : lhs;
+    }
+};
+
+// Нейтральные элементы для min и max
+template <typename T>
+struct highest
+{
+    T operator () ()
+    {
+        return std::numeric_limits<T>::max ();
+    }
+};
+
+template <typename T>
+struct lowest
+{
+    T operator () ()
+    {
+        return std::numeric_limits<T>::lowest ();
+    }
+};
+
+/*
+ * Свойства операции для выбора структуры:
+ *   invertible — есть обратная: inverse (oper (a, b), b) = a; тогда отрезок — разность двух префиксов;
+ *   idempotent — oper (a, a) = a; тогда отрезок покрывается двумя перекрывающимися блоками.
+ */
+template <typename Oper>
+struct oper_traits
+{
+    static const bool invertible = false;
+    static const bool idempotent = false;
+};
+
+template <typename T>
+struct oper_traits <xor_tr<T>>
+{
+    static const bool invertible = true;
+    static const bool idempotent = false;
+    static T inverse (T lhs, T rhs) { return lhs ^ rhs; }
+};
+
+template <typename T>
+struct oper_traits <sum_tr<T>>
+{
+    static const bool invertible = true;
+    static const bool idempotent = false;
+    static T inverse (T lhs, T rhs) { return lhs - rhs; }
+};
+
+template <typename T>
+struct oper_traits <min_tr<T>>
+{
+    static const bool invertible = false;
+    static const bool idempotent = true;
+};
+
+template <typename T>
+struct oper_traits <max_tr<T>>
+{
+    static const bool invertible = false;
+    static const bool idempotent = true;
+};
+
+/*
+ * Дерево Фенвика: n элементов вместо 2 * roundUp (n), запрос и изменение — циклы по младшему биту.
+ * Только для обратимых операций: отрезок [l, r] = inverse (prefix (r + 1), prefix (l))
+ */
+template <typename T, typename Oper, typename Neutral>
+class FenwickTree
+{
+    static_assert (oper_traits<Oper>::invertible, "FenwickTree needs an invertible operation");
+
+    T *tree_;
+    unsigned size_;
+    Oper oper_;
+    Neutral neutral_;
+
+    // oper над элементами [0, end)
+    T prefix (unsigned end)
+    {
+        T result = neutral_ ();
+        for (; end > 0; end &= end - 1)
+            result = oper_ (result, tree_[end]);
+        return result;
+    }
+
+public:
+
+    FenwickTree (unsigned array_size):
+        size_ (array_size)
+    {
+        tree_ = new T [size_ + 1];
+    }
+
+    ~FenwickTree () { delete[] tree_; }
+
+    // Построение за O(n): каждый узел отдаёт свою сумму ближайшему родителю
+    void fillFrom (std::istream &is)
+    {
+        tree_[0] = neutral_ ();
+        for (unsigned i = 1; i <= size_; i++)
+            is >> tree_[i];
+
+        for (unsigned i = 1; i <= size_; i++)
+        {
+            unsigned parent = i + (i & -i);
+            if (parent <= size_)
+                tree_[parent] = oper_ (tree_[parent], tree_[i]);
+        }
+    }
+
+    T getResultAtRange (int l, int r)
+    {
+        return oper_traits<Oper>::inverse (prefix (r + 1), prefix (l));
+    }
+
+    // Старое значение не хранится: оно восстанавливается как отрезок [idx, idx]
+    void change (int idx, T new_value)
+    {
+        T delta = oper_traits<Oper>::inverse (new_value, getResultAtRange (idx, idx));
+        for (unsigned index = idx + 1; index <= size_; index += index & -index)
+            tree_[index] = oper_ (tree_[index], delta);
+    }
+};
+
+/*
+ * Разреженная таблица для неизменяемого массива: table_[k][i] — результат на [i, i + 2^k);
+ * n log n памяти, запрос за O(1) двумя перекрывающимися блоками — только для идемпотентных операций
+ */
+template <typename T, typename Oper, typename Neutral>
+class SparseTable
+{
+    static_assert (oper_traits<Oper>::idempotent, "SparseTable needs an idempotent operation");
+
+    T *table_;
+    unsigned size_;
+    unsigned levels_;
+    Oper oper_;
+    Neutral neutral_;
+
+public:
+
+    SparseTable (unsigned array_size):
+        size_ (array_size)
+    {
+        levels_ = std::bit_width (array_size);
+        table_ = new T [(size_t) levels_ * size_];
+    }
+
+    ~SparseTable () { delete[] table_; }
+
+    void fillFrom (std::istream &is)
+    {
+        for (unsigned i = 0; i < size_; i++)
+            is >> table_[i];
+
+        for (unsigned k = 1; k < levels_; k++)
+        {
+            T *previous = table_ + (size_t) (k - 1) * size_, *current = table_ + (size_t) k * size_;
+            unsigned half = 1u << (k - 1);
+            for (unsigned i = 0; i + 2 * half <= size_; i++)
+                current[i] = oper_ (previous[i], previous[i + half]);
+        }
+    }
+
+    T getResultAtRange (int l, int r)
+    {
+        unsigned k = std::bit_width ((unsigned) (r - l + 1)) - 1;
+        const T *level = table_ + (size_t) k * size_;
+        return oper_ (level[l], level[r + 1 - (1 << k)]);
+    }
+};
+
+/*
+ * Выбор структуры по свойствам операции во время компиляции:
+ * RangeQuery — с изменениями (Фенвик для обратимых, иначе дерево отрезков),
+ * StaticRangeQuery — без изменений (разреженная таблица для идемпотентных, иначе как RangeQuery)
+ */
+template <typename T, typename Oper, typename Neutral>
+using RangeQuery = std::conditional_t <oper_traits<Oper>::invertible,
+                                       FenwickTree <T, Oper, Neutral>,
+                                       SegmentTree <T, Oper, Neutral>>;
+
+template <typename T, typename Oper, typename Neutral>
+using StaticRangeQuery = std::conditional_t <oper_traits<Oper>::idempotent,
+                                             SparseTable <T, Oper, Neutral>,
+                                             RangeQuery <T, Oper, Neutral>>;
+
+struct Query
 {
+    int code, arg1, arg2;
+};
+
+// Прогон запросов; результат — XOR всех ответов, чтобы сравнить структуры между собой
+template <typename Structure>
+void runBenchmark (const char *name, const std::string &values, unsigned n, const std::vector <Query> &queries)
+{
+    Structure tr (n);
+    std::istringstream is (values);
+
+    auto start = std::chrono::steady_clock::now ();
+    tr.fillFrom (is);
+    auto built = std::chrono::steady_clock::now ();
+
+    long long checksum = 0;
+    for (const Query &q: queries)
+    {
+        if (q.code == 1)
+            checksum ^= tr.getResultAtRange (q.arg1, q.arg2);
+        else if constexpr (requires { tr.change (q.arg1, q.arg2); })
+            tr.change (q.arg1, q.arg2);
+    }
+    auto done = std::chrono::steady_clock::now ();
+
+    printf ("  %-14s build %8.3f s  queries %8.3f s  checksum %lld\n", name,
+            std::chrono::duration <double> (built - start).count (),
+            std::chrono::duration <double> (done - built).count (), checksum);
+}
+
+void benchmark (unsigned n, unsigned m)
+{
+    std::mt19937 gen (1);
+    std::uniform_int_distribution <int> value (0, std::numeric_limits<int>::max ());
+    std::uniform_int_distribution <unsigned> position (0, n - 1);
+
+    std::string values;
+    for (unsigned i = 0; i < n; i++)
+        values += std::to_string (value (gen)) + " ";
+
+    // формат задачи: половина запросов — XOR на отрезке, половина — присваивание
+    std::vector <Query> mixed (m), ranges (m);
+    for (unsigned i = 0; i < m; i++)
+    {
+        unsigned l = position (gen), r = position (gen);
+        if (l > r)
+            std::swap (l, r);
+        ranges[i] = {1, (int) l, (int) r};
+        mixed[i] = gen () % 2 ? ranges[i] : Query {2, (int) l, value (gen)};
+    }
+
+    printf ("xor, %u elements, %u queries and updates\n", n, m);
+    runBenchmark <SegmentTree <int, xor_tr<int>, neutral<int>>> ("segment tree", values, n, mixed);
+    runBenchmark <FenwickTree <int, xor_tr<int>, neutral<int>>> ("fenwick tree", values, n, mixed);
+
+    printf ("min, %u elements, %u queries without updates\n", n, m);
+    runBenchmark <SegmentTree <int, min_tr<int>, highest<int>>> ("segment tree", values, n, ranges);
+    runBenchmark <SparseTable <int, min_tr<int>, highest<int>>> ("sparse table", values, n, ranges);
+}
+
+
+int main (int argc, char **argv)
+{
+    if (argc > 1 && !strcmp (argv[1], "bench"))
+    {
+        benchmark (argc > 2 ? atoi (argv[2]) : 500000, argc > 3 ? atoi (argv[3]) : 500000);
+        return 0;
+    }
+
     std::ios_base::sync_with_stdio(false);
     std::cin.tie (0);
     int v, m;
     std::cin >> v >> m;
 
-    SegmentTree <int, xor_tr<int>, neutral<int>> tr (v);
+    RangeQuery <int, xor_tr<int>, neutral<int>> tr (v);
     tr.fillFrom (std::cin);
 
     for (int i = 0; i < m; i++)